@@ -2,6 +2,7 @@
 #include "StudentWorld.h"
 #include "GraphObject.h"
 #include "GameConstants.h"
+#include "Snapshot.h"
 #include <cstdlib>
 
 
@@ -9,29 +10,73 @@
 //that the player is stored individually as a pointer whereas every other Actor is contained in a list
 
 Actor::Actor(StudentWorld* swd, int ID, int x, int y, Direction start, bool Barrier, int bulletEffect, int hitPoints)
-: GraphObject(ID, x, y, start), m_world(swd), m_isBar(Barrier),
-    m_isAlive(true), m_bulletEffect(bulletEffect), m_hitPoints(hitPoints)
+: GraphObject(swd->graphObjects(), ID, x, y, start), m_world(swd), m_bulletEffect(bulletEffect), m_serial(0)
 {
     setVisible(true);       //all Actors (other than exits) are immediately set visible
-    
+    m_slot = swd->getActorStore().add(this, ID, x, y, hitPoints, Barrier);
 }
 
 void Actor::doDamage()
 {
-    m_hitPoints -= 2;  
+    ActorStore& store = m_world->getActorStore();
+    store.setHitPoints(m_slot, store.hitPoints(m_slot) - 2);
+    m_world->rehash(this);
     
-    if (m_hitPoints <= 0)
+    if (store.hitPoints(m_slot) <= 0)
         setDead();
 }
 
+void Actor::spaceEntered(Actor* /* entrant */)
+{}      //most actors don't watch any space
+
+void Actor::saveState(Snapshot& /* snap */) const
+{}      //the world records kind, location, direction, health and turn for every Actor
+
+bool Actor::restoreState(Snapshot& /* snap */)
+{
+    return true;
+}
+
+uint64_t Actor::stateKey() const
+{
+    return 0;
+}
+
 void Actor::setHealth(int toNum)
 {
-    m_hitPoints = toNum;
+    m_world->getActorStore().setHitPoints(m_slot, toNum);
+    m_world->rehash(this);
 }
 
 void Actor::setDead()
 {
-    m_isAlive = false;
+    m_world->getActorStore().setDead(m_slot);
+    m_world->rehash(this);
+}
+
+void Actor::moveTo(int x, int y)
+{
+    int oldX = getX();
+    int oldY = getY();
+    GraphObject::moveTo(x, y);
+    m_world->getActorStore().setLocation(m_slot, x, y);
+    m_world->updateLocation(this, oldX, oldY);     //let the world move this Actor to its new bucket
+}
+
+void Actor::setSerial(unsigned int serial)
+{
+    m_serial = serial;      //set by the world when the Actor is added, gives its position in the list
+}
+
+void Actor::setSlot(int slot)
+{
+    m_slot = slot;          //set by the ActorStore when it compacts
+}
+
+void Actor::setWorld(StudentWorld* world)
+{
+    m_world = world;        //set by a forked world on its copy, which keeps the same slot
+    joinGraphObjects(world->graphObjects());
 }
 
 StudentWorld* Actor::getWorld() const
@@ -56,17 +101,32 @@ int Actor::getBulletEffect() const
 
 bool Actor::isBarrier() const
 {
-    return m_isBar;
+    return m_world->getActorStore().barrier(m_slot);
 }
 
 bool Actor::isAlive() const
 {
-    return m_isAlive;
+    return m_world->getActorStore().alive(m_slot);
 }
 
 int Actor::getHealth() const
 {
-    return m_hitPoints;
+    return m_world->getActorStore().hitPoints(m_slot);
+}
+
+unsigned int Actor::getSerial() const
+{
+    return m_serial;
+}
+
+int Actor::getSlot() const
+{
+    return m_slot;
+}
+
+ActorHandle Actor::getHandle() const
+{
+    return m_world->getActorStore().handleOf(m_slot);
 }
 
 
@@ -78,69 +138,25 @@ deadBot(false)
 
 bool Agent::moveRegular(Direction d)        //all agents move according to the same rules
 {
+    int x = getX();
+    int y = getY();
     
     switch (d)      //d can be four possible values: up, down, left or right
     {
-        case up:
-        {
-            Actor* check = getWorld()->spaceContains(getX(), getY() + 1); //returns pointer to that space
-            
-            
-            //the following code ensures that the space is either empty or does not contain the player, and that there exists no barrier on that space.
-            if (check == nullptr || (getWorld()->checkPlayer(getX(), getY() + 1) &&
-                                     !getWorld()->containsBarrier(getX(), getY() + 1)))
-            {
-                moveTo(getX(), getY() + 1);     //move up
-                return true;
-            }
-            return false;
-        }
-            
-        case right:     //The content of each case is identical other than the changes necessary for
-        {               //different directions
-            
-            Actor* check = getWorld()->spaceContains(getX() + 1, getY());
-            
-            if (check == nullptr || (getWorld()->checkPlayer(getX() + 1, getY()) &&
-                                     !getWorld()->containsBarrier(getX() + 1, getY())))
-            {
-                moveTo(getX() + 1, getY());    //move right
-                return true;
-            }
-            return false;
-        }
-            
-        case down:
-        {
-            Actor* check = getWorld()->spaceContains(getX(), getY() - 1);
-            
-            if (check == nullptr || (getWorld()->checkPlayer(getX(), getY() - 1) &&
-                                     !getWorld()->containsBarrier(getX(), getY() - 1)))
-            {
-                moveTo(getX(), getY() - 1);     //move down
-                return true;
-            }
-            
-            return false;
-        }
-            
-        case left:
-        {
-            Actor* check = getWorld()->spaceContains(getX() - 1, getY());
-            if (check == nullptr || (getWorld()->checkPlayer(getX() - 1, getY()) &&
-                                     !getWorld()->containsBarrier(getX() - 1, getY())))
-            {
-                moveTo(getX() - 1, getY());     //move left
-                return true;
-            }
-            
-        
-            return false;
-        }
+        case up:    y++;    break;
+        case right: x++;    break;
+        case down:  y--;    break;
+        case left:  x--;    break;
         default:
             return false;
     }
-    return false;       //code should never be reached, assuming switch direction is given correctly
+    
+    //the space must not contain the player, and no Actor on that space can serve as a barrier
+    if (!getWorld()->checkPlayer(x, y) || getWorld()->containsBarrier(x, y))
+        return false;
+    
+    moveTo(x, y);
+    return true;
 }
 
 void Agent::shoot()
@@ -182,6 +198,11 @@ Player::Player(StudentWorld* swd, int x, int y)
 : Agent(swd, IID_PLAYER, x, y, 20, SOUND_PLAYER_FIRE, right), m_ammo(20)
 {}
 
+Actor* Player::clone() const
+{
+    return new Player(*this);
+}
+
 void Player::doSomething()
 {
     if (!isAlive())
@@ -199,10 +220,10 @@ void Player::doSomething()
                 
                 if (act != nullptr)
                 {
-                    Boulder* bd = dynamic_cast<Boulder*>(act);      //used to check for a Boulder in
-                    if (bd != nullptr)                              //the intended space to move to
+                    Boulder* bd = getWorld()->getBoulder(getX(), getY() - 1);  //used to check for a Boulder
+                    if (bd != nullptr && bd == act)                            //in the intended space
                     {
-                        if(bd->push(getX(), getY() - 2))            //dynamic_cast pointer needed
+                        if(bd->push(getX(), getY() - 2))            //Boulder pointer needed
                             moveRegular(down);                      // since Boulders serve as exception
                                                                     //Sometimes they are a barrier,
                         break;                                      //sometimes they are moveable
@@ -220,8 +241,8 @@ void Player::doSomething()
                 
                 if (act != nullptr)
                 {
-                    Boulder* bd = dynamic_cast<Boulder*>(act);
-                    if (bd != nullptr)
+                    Boulder* bd = getWorld()->getBoulder(getX(), getY() + 1);
+                    if (bd != nullptr && bd == act)
                     {
                         if (bd->push(getX(), getY() + 2))       //if the space does have a boulder, push it
                             moveRegular(up);
@@ -239,8 +260,8 @@ void Player::doSomething()
                 
                 if (act != nullptr)
                 {
-                    Boulder* bd = dynamic_cast<Boulder*>(act);
-                    if (bd != nullptr)
+                    Boulder* bd = getWorld()->getBoulder(getX() - 1, getY());
+                    if (bd != nullptr && bd == act)
                     {
                         if(bd->push(getX() - 2, getY()))
                             moveRegular(left);
@@ -259,8 +280,8 @@ void Player::doSomething()
                 
                 if (act != nullptr)
                 {
-                    Boulder* bd = dynamic_cast<Boulder*>(act);
-                    if (bd != nullptr)
+                    Boulder* bd = getWorld()->getBoulder(getX() + 1, getY());
+                    if (bd != nullptr && bd == act)
                     {
                         if (bd->push(getX() + 2, getY()))
                             moveRegular(right);
@@ -302,9 +323,25 @@ void Player::doDamage()
     
 }
 
+void Player::saveState(Snapshot& snap) const
+{
+    snap.putInt(m_ammo);
+}
+
+bool Player::restoreState(Snapshot& snap)
+{
+    return snap.getInt(m_ammo);
+}
+
+uint64_t Player::stateKey() const
+{
+    return static_cast<uint32_t>(m_ammo);
+}
+
 void Player::addAmmo()
 {
     m_ammo += 20;
+    getWorld()->rehash(this);   //picked up on the Ammo's turn, not the player's
 }
 
 int Player::healthPercent() const
@@ -330,11 +367,8 @@ void Robot::doSomething()       //this is the beginning sequence for all 3 robot
     if (!isAlive())
         return;
     
-    if (m_tick != 1)     //ensure that the Robot is only acting one per their tick int
-    {
-        decTick();
-        return;
-    }
+    if (!getWorld()->isTurn(this))      //ensure that the Robot is only acting once per their tick int,
+        return;                         //the world only wakes it on that tick
     
     if (doesShoot() && canAim())       //if the robot is a shooting Robot and it is facing toward the player
     {                                  //with a clear, straight path it should shoot
@@ -363,92 +397,19 @@ void Robot::doDamage()
 
 bool Robot::canAim()        //used to see if the player can be shot by the robot
 {
-    
-    //The following series of code repeats the same style of checks for all directions and possibilites:
-    
-    //1. It checks to see if one of the coordinates of the robot is the same as the player's
-    //2. Depending on how the player's second coordinate relates to the robot's second coord, it checks
-                                //that the robot's direction is correct for these relative positions
-    //3. It then loops through all blocks in the way to check that the path is clear for the bullet
-    //4. If all of these are true, it returns true
-    
-    
-    if (getWorld()->getPlayer()->getX() == getX())
-    {
-        if (getWorld()->getPlayer()->getY() > getY() && getDirection() == up)
-        {
-            for (int k = 1; k < getWorld()->getPlayer()->getY() - getY(); k++)
-            {
-                if (getWorld()->spaceContains(getX(), getY() + k) != nullptr)
-                {
-                    if (getWorld()->spaceContains(getX(), getY() + k)->isBarrier())
-                        return false;
-                }
-            }
-            return true;
-        }
-        
-        else if (getWorld()->getPlayer()->getY() < getY() && getDirection() == down)
-        {
-            for (int k = 1; k < getY() - getWorld()->getPlayer()->getY(); k++)
-            {
-                if (getWorld()->spaceContains(getX(), getY() - k) != nullptr)
-                {
-                    if (getWorld()->spaceContains(getX(), getY() - k)->isBarrier())
-                        return false;
-                }
-            }
-            return true;
-        }
-    }
-    
-    
-    else if (getWorld()->getPlayer()->getY() == getY())
-    {
-        if (getWorld()->getPlayer()->getX() > getX() && getDirection() == right)
-        {
-            
-            for (int k = 1; k < getWorld()->getPlayer()->getX() - getX(); k++)
-            {
-                if (getWorld()->spaceContains(getX() + k, getY()) != nullptr)
-                {
-                    if (getWorld()->spaceContains(getX() + k, getY())->isBarrier())
-                        return false;
-                }
-            }
-            return true;
-            
-        }
-        
-        else if (getWorld()->getPlayer()->getX() < getX() && getDirection() == left)
-        {
-            for (int k = 1; k < getX() - getWorld()->getPlayer()->getX(); k++)
-            {
-                if (getWorld()->spaceContains(getX() - k, getY()) != nullptr)
-                {
-                    if (getWorld()->spaceContains(getX() - k, getY())->isBarrier())
-                        return false;
-                }
-            }
-            return true;
-            
-        }
-    }
-    
-    return false;
+    //the robot must be facing toward the player along a row or column, with no barrier on any
+    //space in between.  The world answers this from its precomputed sight lines
+    return getWorld()->playerInSight(getX(), getY(), getDirection());
 }
 
 void Robot::setTick()       //This sets the robots tick to ensure it operates at the correct pace
 {
-    m_tick = (28 - getWorld()->getLevel()) / 4;     //This code was given by the spec
+    int tick = (28 - getWorld()->getLevel()) / 4;     //This code was given by the spec
     
-    if (m_tick < 3)
-        m_tick = 3;
-}
-
-void Robot::decTick()
-{
-    m_tick--;
+    if (tick < 3)
+        tick = 3;
+    
+    getWorld()->scheduleTurn(this, tick);       //act on the tick-th tick it would have been visited
 }
 
 bool Robot::doesShoot() const
@@ -467,6 +428,11 @@ SnarlBot::SnarlBot(StudentWorld* swd, int x, int y, Direction d)
 : Robot(swd, IID_SNARLBOT, x, y, 10 ,d, 100)
 {}
 
+Actor* SnarlBot::clone() const
+{
+    return new SnarlBot(*this);
+}
+
 void SnarlBot::doSomething()
 {
     Robot::doSomething();       //use Base class's doSomething() to complete first few checks
@@ -500,7 +466,7 @@ void SnarlBot::doSomething()
 KleptoBot::KleptoBot(StudentWorld* swd, int ID, int x, int y, int health, int bonus)
 : Robot(swd, ID, x, y, health, right , bonus), hasGoodie(false), m_currentDirectionSteps(0)
 {
-    m_distanceBeforeTurning = rand() % 6 + 1;       //sets the distance to a random number between 1 & 6
+    m_distanceBeforeTurning = swd->randInt(1, 6);       //sets the distance to a random number between 1 & 6
 }
 
 void KleptoBot::doSomething()
@@ -516,7 +482,7 @@ void KleptoBot::doSomething()
     
     if (goodie != nullptr && !hasGoodie)        //if the Robot is on a goodie, and hasn't already taken one:
     {
-        int stealChance = rand() % 10 + 1;  //set stealChance to a random number between 1 & 10
+        int stealChance = getWorld()->randInt(1, 10);  //set stealChance to a random number between 1 & 10
         if (stealChance == 5)   //5 is an arbitray number as it could be any number between 1 & 10
         {
             goodie->setDead();      //destroy the goodie
@@ -550,7 +516,7 @@ void KleptoBot::doSomething()
     
     if (!didMove)       //if it couldn't move, then it must select a random direction and try to move again
     {
-        m_distanceBeforeTurning = rand() % 6 + 1;
+        m_distanceBeforeTurning = getWorld()->randInt(1, 6);
         
         int y = 0;
         bool doneUp = false;
@@ -559,7 +525,7 @@ void KleptoBot::doSomething()
         bool doneLeft = false;
         
         
-        while (int x = rand() % 4 + 1)  //loop serves to check all 4 direction randomly if needed
+        while (int x = getWorld()->randInt(1, 4))  //loop serves to check all 4 direction randomly if needed
         {                               //the done(Dir) boolean ensures that no direction is tested twice
             
             if (y == 0)   //if it's the first iteration of the loop, set y = to the random number from 1 - 4
@@ -640,6 +606,32 @@ void KleptoBot::doDamage()
     
 }
 
+void KleptoBot::saveState(Snapshot& snap) const
+{
+    snap.putInt(m_distanceBeforeTurning);
+    snap.putInt(m_currentDirectionSteps);
+    snap.put(hasGoodie ? goodieKind : 0);       //goodieKind means nothing until a goodie is taken
+}
+
+bool KleptoBot::restoreState(Snapshot& snap)
+{
+    unsigned char kind;
+    if (!snap.getInt(m_distanceBeforeTurning) || !snap.getInt(m_currentDirectionSteps) ||
+        !snap.getUnsigned(kind))
+        return false;
+    
+    hasGoodie = (kind != 0);
+    goodieKind = kind;
+    return true;
+}
+
+uint64_t KleptoBot::stateKey() const
+{
+    uint64_t goodie = hasGoodie ? static_cast<unsigned char>(goodieKind) : 0;
+    return static_cast<uint32_t>(m_distanceBeforeTurning) | uint64_t(m_currentDirectionSteps & 0xFFFFFF) << 32
+         | goodie << 56;
+}
+
 bool KleptoBot::countsInFactoryCount() const
 {
     return true;    //KleptoBot are the only thing counted in the Factory Census
@@ -651,6 +643,11 @@ RegularKleptoBot::RegularKleptoBot(StudentWorld* swd, int x, int y)
 :KleptoBot(swd, IID_KleptoBot, x, y, 5, 10)
 {}
 
+Actor* RegularKleptoBot::clone() const
+{
+    return new RegularKleptoBot(*this);
+}
+
 bool RegularKleptoBot::doesShoot() const
 {
     return false;
@@ -662,6 +659,11 @@ AngryKleptoBot::AngryKleptoBot(StudentWorld* swd, int x, int y)
 :KleptoBot(swd,IID_ANGRY_KleptoBot, x, y, 8, 20)
 {}
 
+Actor* AngryKleptoBot::clone() const
+{
+    return new AngryKleptoBot(*this);
+}
+
 
 
 Barrier::Barrier(StudentWorld* swd, int ID, int x, int y, int hitPoints)
@@ -676,19 +678,30 @@ Wall::Wall(StudentWorld* swd, int x, int y)
 : Barrier(swd, IID_WALL, x, y)
 {}
 
+Actor* Wall::clone() const
+{
+    return new Wall(*this);
+}
+
 
 
 Boulder::Boulder(StudentWorld* swd, int x, int y)
 : Barrier(swd, IID_BOULDER, x, y, 10)
 {}
 
+Actor* Boulder::clone() const
+{
+    return new Boulder(*this);
+}
+
 bool Boulder::push(int moveX, int moveY)
 {
     Actor* space = getWorld()->spaceContains(moveX, moveY);
     
-    Hole* hol = dynamic_cast<Hole*>(space);     //dynamic_cast pointer needed to check for a Hole
+    Hole* hol = getWorld()->getHole(moveX, moveY);     //Hole pointer needed to check for a Hole
     
-    if (space == nullptr || hol != nullptr)     //if the space is empty, or there is a hole, move there
+    if (space == nullptr || (hol != nullptr && space == hol))   //if the space is empty, or there is a
+                                                                //hole, move there
     {
         moveTo(moveX, moveY);
         return true;
@@ -706,7 +719,14 @@ int Boulder::getBulletEffect() const
 
 Hole::Hole(StudentWorld* swd, int x, int y)
 :Barrier(swd, IID_HOLE, x, y)
-{}
+{
+    swd->addSpaceTrigger(this, x, y);   //a Hole only needs to act when something is pushed onto it
+}
+
+Actor* Hole::clone() const
+{
+    return new Hole(*this);
+}
 
 void Hole::doSomething()
 {
@@ -723,6 +743,12 @@ void Hole::doSomething()
     
 }
 
+void Hole::spaceEntered(Actor* entrant)
+{
+    if (isAlive() && entrant == getWorld()->getBoulder(getX(), getY()))
+        getWorld()->scheduleTurn(this, 1);      //a Boulder arrived, fill the hole on this tick
+}
+
 int Hole::getBulletEffect() const
 {
     return BULLET_NOTHING;      //unlike other barriers, a bullet is unaffected by a Hole
@@ -734,9 +760,14 @@ Factory::Factory(StudentWorld* swd, int x, int y, bool angry)
 :Barrier(swd, IID_ROBOT_FACTORY, x, y), m_angry(angry)
 {}
 
+Actor* Factory::clone() const
+{
+    return new Factory(*this);
+}
+
 void Factory::doSomething()
 {
-    int random = rand() % 50 + 1;
+    int random = getWorld()->randInt(1, 50);
     int count = 0;
     bool result = getWorld()->doCensusCount(getX(), getY(), count);     //take census of 7 x 7 surrounding
     
@@ -762,13 +793,32 @@ void Factory::doSomething()
 
 
 
+void Factory::saveState(Snapshot& snap) const
+{
+    snap.put(m_angry);
+}
+
+bool Factory::restoreState(Snapshot& snap)
+{
+    return snap.getUnsigned(m_angry);
+}
+
+uint64_t Factory::stateKey() const
+{
+    return m_angry;
+}
+
+
+
 Accessible::Accessible(StudentWorld* swd, int ID, int x, int y, Direction start)
 : Actor(swd, ID, x, y,start,false)
 {}
 
 Pickup::Pickup(StudentWorld* swd, int ID, int x, int y, int bonus, int sound)
 : Accessible(swd, ID, x, y), m_bonus(bonus), m_sound(sound)
-{}
+{
+    swd->addSpaceTrigger(this, x, y);   //a Pickup only needs to act when the player steps onto it
+}
 
 void Pickup::doSomething()
 {
@@ -785,6 +835,12 @@ void Pickup::doSomething()
     }                                       //this function allows the general Base class doSomething to
 }                                           //function properly
 
+void Pickup::spaceEntered(Actor* entrant)
+{
+    if (entrant == getWorld()->getPlayer())
+        getWorld()->scheduleTurn(this, 1);      //collect it on this tick, in its usual turn
+}
+
 bool Pickup::isOpen() const
 {
     return true;
@@ -805,8 +861,15 @@ Jewel::Jewel(StudentWorld* swd, int x, int y)
 : Pickup(swd, IID_JEWEL, x, y, 50)
 {}
 
+Actor* Jewel::clone() const
+{
+    return new Jewel(*this);
+}
+
 void Jewel::inform()
-{}
+{
+    getWorld()->jewelCollected();       //one fewer Jewel stands between the player and the exit
+}
 
 bool Jewel::isStealable() const
 {
@@ -822,6 +885,11 @@ Exit::Exit(StudentWorld* swd, int x, int y)
     
 }
 
+Actor* Exit::clone() const
+{
+    return new Exit(*this);
+}
+
 void Exit::inform()
 {
     getWorld()->addRunningBonus();      //the Exit additionally adds the running bonus
@@ -831,6 +899,7 @@ void Exit::inform()
 void Exit::setOpen()
 {
     m_open = true;
+    getWorld()->rehash(this);
 }
 
 bool Exit::isOpen() const
@@ -843,12 +912,35 @@ bool Exit::isStealable() const
     return false;
 }
 
+void Exit::saveState(Snapshot& snap) const
+{
+    snap.put(m_open);
+}
+
+bool Exit::restoreState(Snapshot& snap)
+{
+    if (!snap.getUnsigned(m_open))
+        return false;
+    setVisible(m_open);     //the exit only shows once it's open
+    return true;
+}
+
+uint64_t Exit::stateKey() const
+{
+    return m_open;
+}
+
 
 
 ExtraLife::ExtraLife(StudentWorld* swd, int x, int y)
 :Pickup(swd, IID_EXTRA_LIFE, x, y, 1000)
 {}
 
+Actor* ExtraLife::clone() const
+{
+    return new ExtraLife(*this);
+}
+
 void ExtraLife::inform()
 {
     getWorld()->incLives();
@@ -859,6 +951,11 @@ RestoreHealth::RestoreHealth(StudentWorld* swd, int x, int y)
 :Pickup(swd, IID_RESTORE_HEALTH, x, y, 500)
 {}
 
+Actor* RestoreHealth::clone() const
+{
+    return new RestoreHealth(*this);
+}
+
 void RestoreHealth::inform()
 {
     getWorld()->getPlayer()->setHealth(20);
@@ -870,6 +967,11 @@ Ammo::Ammo(StudentWorld* swd, int x, int y)
 : Pickup(swd, IID_AMMO, x, y, 100)
 {}
 
+Actor* Ammo::clone() const
+{
+    return new Ammo(*this);
+}
+
 void Ammo::inform()
 {
     getWorld()->getPlayer()->addAmmo();
@@ -881,6 +983,11 @@ Bullet::Bullet(StudentWorld* swd, int x, int y, Direction d)
 :Accessible(swd, IID_BULLET, x, y, d)
 {}
 
+Actor* Bullet::clone() const
+{
+    return new Bullet(*this);
+}
+
 void Bullet::doSomething()
 {
     if (!isAlive())
@@ -930,12 +1037,26 @@ bool Bullet::attemptHit()
         return true;
     }
     
-    Actor* target = getWorld()->spaceContains(getX(), getY());
-    Actor* target2 = getWorld()->secondBulletCheck(getX(), getY());
+    //one lookup gives both the first Actor on the space and the first one a bullet can strike
+    const vector<ActorHandle>& here = getWorld()->occupantsOf(getX(), getY());
+    
+    Actor* target = nullptr;
+    Actor* target2 = nullptr;
+    for (size_t k = 0; k < here.size(); k++)
+    {
+        Actor* act = getWorld()->lookup(here[k]);
+        if (target == nullptr)
+            target = act;
+        if (act->getBulletEffect() == BULLET_STRIKES)
+        {
+            target2 = act;
+            break;
+        }
+    }
     
     
-    if (target != nullptr)      // realistically target can never be the nullptr since spaceContains will
-        // at least return a pointer to the actor in bullet.
+    if (target != nullptr)      // realistically target can never be the nullptr since the bullet itself
+        // is always on the space.
     {
         
         if (target->getBulletEffect() == BULLET_STRIKES)        //BULLET_STRIKES means to do damage
@@ -972,10 +1093,3 @@ bool Bullet::attemptHit()
     }
     return false;
 }
-
-
-
-
-
-
-
@@ -3,6 +3,7 @@
 
 #include "GraphObject.h"
 #include "GameConstants.h"
+#include "ActorStore.h"
 #include <iostream>
 #include <string>
 using namespace std;
@@ -12,6 +13,7 @@ const int BULLET_NOTHING = 0;
 const int BULLET_STRIKES = 1;
 
 class StudentWorld;
+class Snapshot;
 
 class Actor : public GraphObject
 {
@@ -20,10 +22,19 @@ public:
     virtual ~Actor(){}
     
     virtual void doSomething() = 0;
+    virtual Actor* clone() const = 0;   //a copy for a forked world, which then calls setWorld()
     virtual void doDamage();
+    virtual void spaceEntered(Actor* entrant);      //for Actors watching a space with a trigger
+    virtual void saveState(Snapshot& snap) const;   //whatever this kind of Actor keeps that the
+    virtual bool restoreState(Snapshot& snap);      //world's snapshot doesn't already cover
+    virtual uint64_t stateKey() const;              //the same state, packed for the world's hash
     
     void setHealth(int toNum);
     void setDead();
+    void moveTo(int x, int y);      //hides GraphObject::moveTo so the world's spatial index stays current
+    void setSerial(unsigned int serial);
+    void setSlot(int slot);
+    void setWorld(StudentWorld* world);
 
     StudentWorld* getWorld() const;
     virtual bool isStealable() const;
@@ -32,13 +43,15 @@ public:
     bool isBarrier() const;
     bool isAlive() const;
     int getHealth() const;
+    unsigned int getSerial() const;
+    int getSlot() const;
+    ActorHandle getHandle() const;      //keep this, not the pointer, to refer to the Actor later
     
 private:
     StudentWorld* m_world;
-    bool m_isBar;
-    bool m_isAlive;
     int m_bulletEffect;
-    int m_hitPoints;
+    unsigned int m_serial;
+    int m_slot;             //where the world's ActorStore keeps this Actor's health, flags and location
 };
 
 class Agent : public Actor
@@ -61,9 +74,13 @@ class Player : public Agent
 {
 public:
     Player(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     
     virtual void doSomething();
     virtual void doDamage();
+    virtual void saveState(Snapshot& snap) const;
+    virtual bool restoreState(Snapshot& snap);
+    virtual uint64_t stateKey() const;
     void addAmmo();
     
     int healthPercent() const;
@@ -84,13 +101,11 @@ public:
 
     bool canAim();
     void setTick();
-    void decTick();
     
     virtual bool doesShoot() const;
     bool shouldContinue() const;
     
 private:
-    int m_tick;
     int m_bonus;
     bool m_continue;
 };
@@ -100,6 +115,7 @@ class SnarlBot : public Robot
 {
 public:
     SnarlBot(StudentWorld* swd, int x, int y, Direction d);
+    virtual Actor* clone() const;
     virtual void doSomething();
 };
 
@@ -112,6 +128,9 @@ public:
     virtual void doSomething();
     virtual void doDamage();
     virtual bool countsInFactoryCount() const;
+    virtual void saveState(Snapshot& snap) const;
+    virtual bool restoreState(Snapshot& snap);
+    virtual uint64_t stateKey() const;
     
 private:
     int m_distanceBeforeTurning;
@@ -125,6 +144,7 @@ class RegularKleptoBot : public KleptoBot
 {
 public:
     RegularKleptoBot(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual bool doesShoot() const;
 };
 
@@ -133,6 +153,7 @@ class AngryKleptoBot : public KleptoBot
 {
 public:
     AngryKleptoBot(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
 };
 
 
@@ -149,6 +170,7 @@ class Wall : public Barrier
 {
 public:
     Wall(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
 };
 
 
@@ -156,6 +178,7 @@ class Boulder : public Barrier
 {
 public:
     Boulder(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     bool push(int moveX, int moveY);
     virtual int getBulletEffect() const;
 };
@@ -164,7 +187,9 @@ class Hole : public Barrier
 {
 public:
     Hole(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual void doSomething();
+    virtual void spaceEntered(Actor* entrant);
     virtual int getBulletEffect() const;
 };
 
@@ -172,7 +197,11 @@ class Factory : public Barrier
 {
 public:
     Factory(StudentWorld* swd, int x, int y, bool angry);
+    virtual Actor* clone() const;
     virtual void doSomething();
+    virtual void saveState(Snapshot& snap) const;
+    virtual bool restoreState(Snapshot& snap);
+    virtual uint64_t stateKey() const;
 private:
     bool m_angry;
 };
@@ -195,6 +224,7 @@ public:
     virtual ~Pickup(){}
     
     virtual void doSomething();
+    virtual void spaceEntered(Actor* entrant);
     virtual void inform() = 0;
     virtual bool isOpen() const;
     virtual bool isStealable() const;
@@ -209,6 +239,7 @@ class Jewel : public Pickup
 {
 public:
     Jewel(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual void inform();
     virtual bool isStealable() const;
 };
@@ -218,10 +249,14 @@ class Exit : public Pickup
 {
 public:
     Exit(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual void inform();
     void setOpen();
     virtual bool isOpen() const;
     virtual bool isStealable() const;
+    virtual void saveState(Snapshot& snap) const;
+    virtual bool restoreState(Snapshot& snap);
+    virtual uint64_t stateKey() const;
 
 private:
     bool m_open;
@@ -232,6 +267,7 @@ class ExtraLife : public Pickup
 {
 public:
     ExtraLife(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual void inform();
 };
 
@@ -240,6 +276,7 @@ class RestoreHealth : public Pickup
 {
 public:
     RestoreHealth(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual void inform();
 };
 
@@ -248,6 +285,7 @@ class Ammo : public Pickup
 {
 public:
     Ammo(StudentWorld* swd, int x, int y);
+    virtual Actor* clone() const;
     virtual void inform();
 private:
 };
@@ -257,6 +295,7 @@ class Bullet : public Accessible
 {
 public:
     Bullet (StudentWorld* swd, int x, int y, Direction d);
+    virtual Actor* clone() const;
     virtual void doSomething();
     bool attemptHit();
 };
@@ -0,0 +1,141 @@
+#include "ActorStore.h"
+#include "Actor.h"
+using namespace std;
+
+int ActorStore::add(Actor* act, int kind, int x, int y, int hitPoints, bool barrier)
+{
+    int index;
+    if (!m_freeHandles.empty())     //reuse a released handle entry, its generation already moved on
+    {
+        index = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else
+    {
+        index = static_cast<int>(m_slotOf.size());
+        m_slotOf.push_back(0);
+        m_generation.push_back(0);
+    }
+    m_slotOf[index] = size();
+    
+    m_actor.push_back(act);
+    m_handle.push_back(index);
+    m_kind.push_back(kind);
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_hitPoints.push_back(hitPoints);
+    m_tick.push_back(0);
+    m_alive.push_back(1);
+    m_barrier.push_back(barrier ? 1 : 0);
+    m_hashTerm.push_back(0);
+
+    return size() - 1;      //new Actors always go in the last slot
+}
+
+void ActorStore::compact()
+{
+    //slide every living Actor down over the dead ones.  Dead Actors have already been deleted, so
+    //only their flags are read
+    int kept = 0;
+    int keptStatic = 0;
+    for (int slot = 0; slot < size(); slot++)
+    {
+        if (!m_alive[slot])
+        {
+            int index = m_handle[slot];     //release the handle so old copies of it stop resolving
+            m_generation[index]++;
+            m_freeHandles.push_back(index);
+            continue;
+        }
+
+        if (kept != slot)
+            copySlot(*this, slot, kept);
+        kept++;
+        
+        if (slot < m_firstDynamic)
+            keptStatic++;
+    }
+    
+    m_firstDynamic = keptStatic;
+
+    m_actor.resize(kept);
+    m_handle.resize(kept);
+    m_kind.resize(kept);
+    m_x.resize(kept);
+    m_y.resize(kept);
+    m_hitPoints.resize(kept);
+    m_tick.resize(kept);
+    m_alive.resize(kept);
+    m_barrier.resize(kept);
+    m_hashTerm.resize(kept);
+}
+
+void ActorStore::partition(bool (*isStatic)(int kind))
+{
+    //copy the arrays, then write the static Actors back first and the rest after them, each group
+    //in its original order
+    ActorStore old(*this);
+    
+    int next = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1)
+            m_firstDynamic = next;
+        
+        for (int slot = 0; slot < old.size(); slot++)
+        {
+            if (isStatic(old.m_kind[slot]) != (pass == 0))
+                continue;
+            
+            copySlot(old, slot, next);
+            next++;
+        }
+    }
+}
+
+void ActorStore::copySlot(const ActorStore& src, int from, int to)   //to must be a slot in this store
+{
+    m_actor[to] = src.m_actor[from];
+    m_handle[to] = src.m_handle[from];
+    m_kind[to] = src.m_kind[from];
+    m_x[to] = src.m_x[from];
+    m_y[to] = src.m_y[from];
+    m_hitPoints[to] = src.m_hitPoints[from];
+    m_tick[to] = src.m_tick[from];
+    m_alive[to] = src.m_alive[from];
+    m_barrier[to] = src.m_barrier[from];
+    m_hashTerm[to] = src.m_hashTerm[from];
+    m_slotOf[m_handle[to]] = to;        //keep the slot map and the Actor pointing at the new slot
+    m_actor[to]->setSlot(to);
+}
+
+void ActorStore::clear()
+{
+    for (int slot = 0; slot < size(); slot++)  //every outstanding handle goes stale
+    {
+        m_generation[m_handle[slot]]++;
+        m_freeHandles.push_back(m_handle[slot]);
+    }
+    
+    m_actor.clear();
+    m_handle.clear();
+    m_kind.clear();
+    m_x.clear();
+    m_y.clear();
+    m_hitPoints.clear();
+    m_tick.clear();
+    m_alive.clear();
+    m_barrier.clear();
+    m_hashTerm.clear();
+    m_firstDynamic = 0;
+}
+
+size_t ActorStore::bytes() const       //what the arrays take on the heap
+{
+    return m_slotOf.capacity() * sizeof(int) + m_generation.capacity() * sizeof(unsigned int)
+         + m_freeHandles.capacity() * sizeof(int) + m_actor.capacity() * sizeof(Actor*)
+         + (m_handle.capacity() + m_kind.capacity() + m_x.capacity() + m_y.capacity()
+            + m_hitPoints.capacity()) * sizeof(int)
+         + m_tick.capacity() * sizeof(unsigned int) + m_alive.capacity() + m_barrier.capacity()
+         + m_hashTerm.capacity() * sizeof(uint64_t);
+}
@@ -0,0 +1,134 @@
+#ifndef ACTORSTORE_H_
+#define ACTORSTORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Actor;
+
+// ActorStore keeps the state the tick loop reads for every Actor in parallel arrays, one entry per
+// slot, instead of inside each heap-allocated Actor.  Slots are kept in the order the Actors were
+// added, which is the order they act in, so a pass over the arrays visits Actors in that order.
+// The Actor objects themselves stay as handles that know their slot.
+//
+// Slots move when the store compacts, so anything that holds on to an Actor keeps an ActorHandle
+// instead.  A handle names an entry in a slot map that always knows the Actor's current slot, and
+// carries the generation the entry had when it was handed out.  Once the Actor is removed the
+// entry's generation changes, so looking up an old handle safely gives back nullptr.
+//
+// Actors that never act (walls, boulders, and the player, who moves before everyone else) can be
+// gathered at the front of the store once a level is loaded.  The per-tick pass then starts at
+// firstDynamic() and never visits them.  Actors added later always go at the back.
+
+struct ActorHandle
+{
+    ActorHandle()
+     : index(-1), generation(0)
+    {}
+    
+    ActorHandle(int idx, unsigned int gen)
+     : index(idx), generation(gen)
+    {}
+    
+    bool operator==(const ActorHandle& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    
+    int index;
+    unsigned int generation;
+};
+
+class ActorStore
+{
+public:
+    ActorStore()
+     : m_firstDynamic(0)
+    {}
+    
+    int add(Actor* act, int kind, int x, int y, int hitPoints, bool barrier);
+    void compact();         //drops the slots of dead Actors, keeping the rest in order
+    void clear();
+    void partition(bool (*isStatic)(int kind));     //stable, static kinds first
+    size_t bytes() const;
+    
+    int firstDynamic() const
+    {
+        return m_firstDynamic;
+    }
+    
+    ActorHandle handleOf(int slot) const
+    {
+        int index = m_handle[slot];
+        return ActorHandle(index, m_generation[index]);
+    }
+    
+    int slotOf(ActorHandle h) const     //-1 if the Actor is gone
+    {
+        if (h.index < 0 || h.index >= static_cast<int>(m_slotOf.size()) ||
+            m_generation[h.index] != h.generation)
+            return -1;
+        return m_slotOf[h.index];
+    }
+    
+    Actor* lookup(ActorHandle h) const  //nullptr if the Actor is gone
+    {
+        int slot = slotOf(h);
+        return slot < 0 ? nullptr : m_actor[slot];
+    }
+
+    int size() const
+    {
+        return static_cast<int>(m_actor.size());
+    }
+
+    Actor* actor(int slot) const            { return m_actor[slot]; }
+    void setActor(int slot, Actor* act)     { m_actor[slot] = act; }    //a forked world's own copy
+    int kind(int slot) const                { return m_kind[slot]; }    //the Actor's image ID
+
+    int x(int slot) const                   { return m_x[slot]; }
+    int y(int slot) const                   { return m_y[slot]; }
+    void setLocation(int slot, int x, int y)
+    {
+        m_x[slot] = x;
+        m_y[slot] = y;
+    }
+
+    int hitPoints(int slot) const           { return m_hitPoints[slot]; }
+    void setHitPoints(int slot, int hp)     { m_hitPoints[slot] = hp; }
+
+    bool alive(int slot) const              { return m_alive[slot] != 0; }
+    void setDead(int slot)                  { m_alive[slot] = 0; }
+
+    bool barrier(int slot) const            { return m_barrier[slot] != 0; }
+
+    unsigned int tick(int slot) const               { return m_tick[slot]; }
+    void setTick(int slot, unsigned int tick)       { m_tick[slot] = tick; }
+
+    uint64_t hashTerm(int slot) const               { return m_hashTerm[slot]; }    //what the Actor
+    void setHashTerm(int slot, uint64_t term)       { m_hashTerm[slot] = term; }    //adds to the
+                                                                                    //world's hash
+
+private:
+    std::vector<int> m_slotOf;              //the slot map, indexed by handle
+    std::vector<unsigned int> m_generation;
+    std::vector<int> m_freeHandles;
+
+    std::vector<Actor*> m_actor;
+    std::vector<int> m_handle;              //per slot, the handle index that points back at it
+    std::vector<int> m_kind;
+    std::vector<int> m_x;
+    std::vector<int> m_y;
+    std::vector<int> m_hitPoints;
+    std::vector<unsigned int> m_tick;       //the tick an Actor next acts on
+    std::vector<unsigned char> m_alive;
+    std::vector<unsigned char> m_barrier;
+    std::vector<uint64_t> m_hashTerm;
+    
+    int m_firstDynamic;
+
+    void copySlot(const ActorStore& src, int from, int to);
+};
+
+#endif // ACTORSTORE_H_
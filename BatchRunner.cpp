@@ -0,0 +1,46 @@
+#include "BatchRunner.h"
+#include "GameWorld.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+using namespace std;
+
+GameWorld* createStudentWorld(string assetDir, unsigned int seed);
+
+BatchRunner::Summary BatchRunner::run(int worlds, int threads)
+{
+	if (threads < 1)
+		threads = 1;
+	m_reports.assign(worlds, HeadlessController::Report());
+
+	atomic<int> nextWorld(0);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	vector<thread> workers;
+	for (int t = 0; t < threads; t++)
+	{
+		workers.push_back(thread([this, worlds, &nextWorld]()
+		{
+			for (int k = nextWorld++; k < worlds; k = nextWorld++)
+			{
+				GameWorld* gw = createStudentWorld(m_assetDir, m_firstSeed + k);	// world k always plays the same game
+				HeadlessController controller(m_keyScript);
+				m_reports[k] = controller.run(gw, m_ticksPerWorld);		// each world has its own report
+				delete gw;
+			}
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+	Summary summary;
+	summary.threads = threads;
+	summary.worlds = worlds;
+	summary.ticks = 0;
+	for (int k = 0; k < worlds; k++)
+		summary.ticks += m_reports[k].ticks;
+	summary.seconds = elapsed.count();
+	return summary;
+}
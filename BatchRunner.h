@@ -0,0 +1,51 @@
+#ifndef BATCHRUNNER_H_
+#define BATCHRUNNER_H_
+
+#include "HeadlessController.h"
+#include <string>
+#include <vector>
+
+  // BatchRunner plays many independent games at once.  A pool of worker
+  // threads takes games off a shared counter.  Each game gets its own world
+  // and its own HeadlessController, and stays on one thread from init to
+  // delete, so games never share any state.
+
+class BatchRunner
+{
+  public:
+	struct Summary
+	{
+		int			threads;
+		int			worlds;
+		long long	ticks;			// across every world
+		double		seconds;		// wall clock for the whole batch
+
+		double ticksPerSecond() const
+		{
+			return seconds > 0 ? ticks / seconds : 0;
+		}
+	};
+
+	BatchRunner(std::string assetDir, std::string keyScript, long long ticksPerWorld,
+				unsigned int firstSeed = 0)
+	 : m_assetDir(assetDir), m_keyScript(keyScript), m_ticksPerWorld(ticksPerWorld),
+	   m_firstSeed(firstSeed)
+	{
+	}
+
+	Summary run(int worlds, int threads);
+
+	const std::vector<HeadlessController::Report>& reports() const	// one per world, from the last run
+	{
+		return m_reports;
+	}
+
+  private:
+	std::string	m_assetDir;
+	std::string	m_keyScript;
+	long long	m_ticksPerWorld;
+	unsigned int m_firstSeed;	// world k is seeded with m_firstSeed + k
+	std::vector<HeadlessController::Report> m_reports;
+};
+
+#endif // BATCHRUNNER_H_
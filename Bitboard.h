@@ -0,0 +1,199 @@
+#ifndef BITBOARD_H_
+#define BITBOARD_H_
+
+#include "GameConstants.h"
+#include <cstdint>
+
+// A Bitboard holds one bit for every space on the board.  Bit (y * VIEW_WIDTH + x) stands for
+// space (x, y), so a whole 15 x 15 board fits in four 64-bit words.  Every operation works on a
+// full word at a time, and the fixed-size loops are simple enough for the compiler to vectorize.
+
+const int BOARD_SPACES = VIEW_WIDTH * VIEW_HEIGHT;
+const int BITBOARD_WORDS = (BOARD_SPACES + 63) / 64;
+
+class Bitboard
+{
+public:
+    Bitboard()
+    {
+        clear();
+    }
+
+    static bool onBoard(int x, int y)
+    {
+        return x >= 0 && x < VIEW_WIDTH && y >= 0 && y < VIEW_HEIGHT;
+    }
+
+    static int index(int x, int y)
+    {
+        return y * VIEW_WIDTH + x;
+    }
+
+    void clear()
+    {
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            m_words[k] = 0;
+    }
+
+    void set(int x, int y)
+    {
+        int i = index(x, y);
+        m_words[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    void reset(int x, int y)
+    {
+        int i = index(x, y);
+        m_words[i / 64] &= ~(uint64_t(1) << (i % 64));
+    }
+
+    void assign(int x, int y, bool value)
+    {
+        if (value)
+            set(x, y);
+        else
+            reset(x, y);
+    }
+
+    bool test(int x, int y) const   //spaces off the board are never set
+    {
+        if (!onBoard(x, y))
+            return false;
+        int i = index(x, y);
+        return (m_words[i / 64] >> (i % 64)) & 1;
+    }
+
+    bool any() const
+    {
+        uint64_t all = 0;
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            all |= m_words[k];
+        return all != 0;
+    }
+
+    bool intersects(const Bitboard& other) const
+    {
+        uint64_t all = 0;
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            all |= m_words[k] & other.m_words[k];
+        return all != 0;
+    }
+
+    int lowest() const      //index of the lowest set bit, or -1 if there is none
+    {
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            if (m_words[k] != 0)
+                return 64 * k + bitIndex(m_words[k] & (~m_words[k] + 1));
+        return -1;
+    }
+
+    int highest() const     //index of the highest set bit, or -1 if there is none
+    {
+        for (int k = BITBOARD_WORDS - 1; k >= 0; k--)
+        {
+            if (m_words[k] != 0)
+            {
+                uint64_t w = m_words[k];
+                for (int shift = 1; shift < 64; shift *= 2)     //smear the top bit downward
+                    w |= w >> shift;
+                return 64 * k + bitIndex(w ^ (w >> 1));
+            }
+        }
+        return -1;
+    }
+
+    static Bitboard ray(int x, int y, int dx, int dy)   //every space from (x, y) outward, not (x, y)
+    {
+        Bitboard result;
+        for (x += dx, y += dy; onBoard(x, y); x += dx, y += dy)
+            result.set(x, y);
+        return result;
+    }
+
+    int count() const
+    {
+        int total = 0;
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            total += popCount(m_words[k]);
+        return total;
+    }
+
+    Bitboard& operator&=(const Bitboard& other)
+    {
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            m_words[k] &= other.m_words[k];
+        return *this;
+    }
+
+    Bitboard& operator|=(const Bitboard& other)
+    {
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            m_words[k] |= other.m_words[k];
+        return *this;
+    }
+
+    Bitboard operator&(const Bitboard& other) const
+    {
+        Bitboard result = *this;
+        result &= other;
+        return result;
+    }
+
+    Bitboard operator|(const Bitboard& other) const
+    {
+        Bitboard result = *this;
+        result |= other;
+        return result;
+    }
+
+    Bitboard operator~() const      //only bits that stand for a space are flipped
+    {
+        Bitboard result;
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            result.m_words[k] = ~m_words[k];
+        result.m_words[BITBOARD_WORDS - 1] &= lastWordMask();
+        return result;
+    }
+
+    uint64_t word(int k) const      //for hashing, bits 64 * k up to 64 * k + 63
+    {
+        return m_words[k];
+    }
+
+    bool operator==(const Bitboard& other) const
+    {
+        for (int k = 0; k < BITBOARD_WORDS; k++)
+            if (m_words[k] != other.m_words[k])
+                return false;
+        return true;
+    }
+
+    bool operator!=(const Bitboard& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    uint64_t m_words[BITBOARD_WORDS];
+
+    static uint64_t lastWordMask()
+    {
+        int used = BOARD_SPACES - 64 * (BITBOARD_WORDS - 1);
+        return used == 64 ? ~uint64_t(0) : (uint64_t(1) << used) - 1;
+    }
+
+    static int bitIndex(uint64_t singleBit)
+    {
+        return popCount(singleBit - 1);
+    }
+
+    static int popCount(uint64_t w)
+    {
+        w = w - ((w >> 1) & 0x5555555555555555ULL);
+        w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+        w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return int((w * 0x0101010101010101ULL) >> 56);
+    }
+};
+
+#endif // BITBOARD_H_
@@ -0,0 +1,54 @@
+#include "BulletPool.h"
+#include <new>
+using namespace std;
+
+BulletPool::BulletPool()
+ : m_records(nullptr)
+{}
+
+BulletPool::~BulletPool()
+{
+    delete [] m_records;    //the world destroys every Bullet before it lets go of the pool
+}
+
+Bullet* BulletPool::create(StudentWorld* swd, int x, int y, GraphObject::Direction d)
+{
+    if (m_records == nullptr)
+    {
+        m_records = new Record[CAPACITY];
+        for (int k = CAPACITY - 1; k >= 0; k--)     //hand out the lowest records first
+            m_free.push_back(k);
+    }
+    
+    if (m_free.empty())
+        return new Bullet(swd, x, y, d);
+    
+    int k = m_free.back();
+    m_free.pop_back();
+    return new (m_records[k].bytes) Bullet(swd, x, y, d);
+}
+
+bool BulletPool::destroy(Actor* act)
+{
+    if (!owns(act))
+        return false;
+    
+    Record* rec = reinterpret_cast<Record*>(act);
+    act->~Actor();
+    m_free.push_back(static_cast<int>(rec - m_records));
+    return true;
+}
+
+size_t BulletPool::bytes() const
+{
+    return m_records == nullptr ? 0 : CAPACITY * sizeof(Record) + m_free.capacity() * sizeof(int);
+}
+
+bool BulletPool::owns(const Actor* act) const
+{
+    if (m_records == nullptr)
+        return false;
+    
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(act);
+    return p >= m_records[0].bytes && p < m_records[CAPACITY - 1].bytes + sizeof(Record);
+}
@@ -0,0 +1,41 @@
+#ifndef BULLETPOOL_H_
+#define BULLETPOOL_H_
+
+#include "Actor.h"
+#include <vector>
+
+// Bullets come and go more than any other Actor, so the world builds them in a fixed block of
+// storage owned by the pool instead of on the heap.  Freed records go on a free list and are
+// reused by the next shot.  If every record is in use the pool falls back to new and delete.
+// The block is only allocated for the first shot, so a forked world that never fires costs nothing.
+
+class BulletPool
+{
+public:
+    BulletPool();
+    ~BulletPool();
+
+    Bullet* create(StudentWorld* swd, int x, int y, GraphObject::Direction d);
+    bool destroy(Actor* act);       //false if act is not a Bullet built by this pool
+    size_t bytes() const;
+    
+    static const int CAPACITY = 64;
+
+private:
+    union Record        //raw storage for one Bullet, aligned as a Bullet needs
+    {
+        double alignAsDouble;
+        void* alignAsPointer;
+        unsigned char bytes[sizeof(Bullet)];
+    };
+
+    Record* m_records;
+    std::vector<int> m_free;
+
+    bool owns(const Actor* act) const;
+
+    BulletPool(const BulletPool&);
+    BulletPool& operator=(const BulletPool&);
+};
+
+#endif // BULLETPOOL_H_
@@ -0,0 +1,97 @@
+#ifndef COWGRID_H_
+#define COWGRID_H_
+
+#include "GameConstants.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// A CowGrid holds one T for every space on the board, kept as a row of VIEW_WIDTH spaces per chunk.
+// Copying a grid copies only the row pointers, so a forked world starts out sharing every row with
+// the world it came from.  The first edit() of a shared row gives the grid its own copy of that
+// row, and rows nobody edits stay shared for as long as both grids live.
+//
+// Reading with at() never copies anything, so code that only looks at a space should use it.
+// Grids that share rows may be used on different threads.
+
+template<typename T>
+class CowGrid
+{
+public:
+    CowGrid()
+    {
+        for (int y = 0; y < VIEW_HEIGHT; y++)
+            m_rows[y] = std::make_shared<Row>();
+    }
+
+    const T& at(int x, int y) const
+    {
+        return (*m_rows[y])[x];
+    }
+
+    T& edit(int x, int y)
+    {
+        std::shared_ptr<Row>& row = m_rows[y];
+        if (row.use_count() > 1)
+            row = std::make_shared<Row>(*row);      //shared, so this grid needs its own copy first
+        else
+            std::atomic_thread_fence(std::memory_order_acquire);    //whoever let go is done reading
+        return (*row)[x];
+    }
+
+    void fill(const T& value)
+    {
+        for (int y = 0; y < VIEW_HEIGHT; y++)
+            m_rows[y] = std::make_shared<Row>(value);
+    }
+
+    size_t unsharedBytes() const    //the rows only this grid holds, and what their spaces hold
+    {
+        size_t bytes = 0;
+        for (int y = 0; y < VIEW_HEIGHT; y++)
+        {
+            if (m_rows[y].use_count() > 1)
+                continue;
+
+            bytes += sizeof(Row);
+            for (int x = 0; x < VIEW_WIDTH; x++)
+                bytes += heapBytes((*m_rows[y])[x]);
+        }
+        return bytes;
+    }
+
+private:
+    struct Row
+    {
+        Row()
+        {}
+
+        explicit Row(const T& value)
+        {
+            for (int x = 0; x < VIEW_WIDTH; x++)
+                spaces[x] = value;
+        }
+
+        T& operator[](int x)                { return spaces[x]; }
+        const T& operator[](int x) const    { return spaces[x]; }
+
+        T spaces[VIEW_WIDTH];
+    };
+
+    std::shared_ptr<Row> m_rows[VIEW_HEIGHT];
+
+    template<typename U>
+    static size_t heapBytes(const std::vector<U>& v)
+    {
+        return v.capacity() * sizeof(U);
+    }
+
+    template<typename U>
+    static size_t heapBytes(const U&)
+    {
+        return 0;
+    }
+};
+
+#endif // COWGRID_H_
@@ -5,6 +5,7 @@
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
+#include "Trace.h"
 #include <string>
 #include <map>
 #include <utility>
@@ -310,12 +311,14 @@ void GameController::doSomething()
 
 void GameController::displayGamePlay()
 {
+    TRACE_ZONE("GameController::displayGamePlay");
     glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
     glLoadIdentity();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     gluLookAt(0, 0, 0, 0, 0, -1, 0, 1, 0);
     
-    std::set<GraphObject*>& graphObjects = GraphObject::getGraphObjects();
+    TraceZone plotSprites("plot sprites");
+    std::set<GraphObject*>& graphObjects = m_gw->graphObjects();
     for (auto it = graphObjects.begin(); it != graphObjects.end(); it++)
     {
         GraphObject* cur = *it;
@@ -349,9 +352,13 @@ void GameController::displayGamePlay()
             m_spriteManager.plotSprite(imageID, frame, gx, gy, gz, angle);
         }
     }
+    plotSprites.end();
     
+    TraceZone hudText("HUD text");
     drawScoreAndLives(m_gameStatText);
+    hudText.end();
     
+    TraceZone swapBuffers("swap buffers");
     glutSwapBuffers();
 }
 
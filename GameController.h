@@ -2,8 +2,10 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "WorldController.h"
 #include <string>
 #include <map>
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 
@@ -16,12 +18,12 @@ const int INVALID_KEY = 0;
 class GraphObject;
 class GameWorld;
 
-class GameController
+class GameController : public WorldController
 {
   public:
 	void run(GameWorld* gw, std::string windowTitle);
 
-	bool getLastKey(int& value)
+	virtual bool getLastKey(int& value)
 	{
 		if (m_lastKeyHit != INVALID_KEY)
 		{
@@ -35,9 +37,14 @@ class GameController
 	void keyboardEvent(unsigned char key, int x, int y);
 	void specialKeyboardEvent(int key, int x, int y);
 	
-	void playSound(int soundID);
+	virtual void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	virtual void quitRequested()
+	{
+		exit(0);
+	}
+
+	virtual void setGameStatText(std::string text)
 	{
 		m_gameStatText = text;
 	}
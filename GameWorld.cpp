@@ -1,15 +1,18 @@
 #include "GameWorld.h"
-#include "GameController.h"
+#include "WorldController.h"
+#include "Replay.h"
 #include <string>
-#include <cstdlib>
 using namespace std;
 
 bool GameWorld::getKey(int& value)
 {
 	bool gotKey = m_controller->getLastKey(value);
 
+	if (m_recording != nullptr)
+		m_recording->recordKey(gotKey, gotKey ? value : 0);
+
 	if (gotKey && (value == 'q' || value == '\x03'))  // CTRL-C
-			exit(0);
+		m_controller->quitRequested();	// the window exits, a headless game stops after this tick
 
 	return gotKey;
 }
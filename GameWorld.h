@@ -2,11 +2,17 @@
 #define GAMEWORLD_H_
 
 #include "GameConstants.h"
+#include "Replay.h"
+#include <set>
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 const int START_PLAYER_LIVES = 3;
 
-class GameController;
+class GraphObject;
+class WorldController;
+class Snapshot;
 
 class GameWorld
 {
@@ -14,7 +20,7 @@ public:
 
 	GameWorld(std::string assetDir)
 	 : m_lives(START_PLAYER_LIVES), m_score(0), m_level(0),
-	   m_controller(nullptr), m_assetDir(assetDir)
+	   m_controller(nullptr), m_recording(nullptr), m_assetDir(assetDir)
 	{
 	}
 
@@ -72,7 +78,7 @@ public:
 		++m_level;
 	}
    
-	void setController(GameController* controller)
+	void setController(WorldController* controller)
 	{
 		m_controller = controller;
 	}
@@ -81,13 +87,90 @@ public:
 	{
 		return m_assetDir;
 	}
+
+	  // every GraphObject in this world, and no other; each one joins it as
+	  // it is made and leaves it as it is deleted
+	std::set<GraphObject*>& graphObjects()
+	{
+		return m_graphObjects;
+	}
+
+	  // every key getKey returns from now on, and every tick without one, is
+	  // added to the replay
+	void startRecording(Replay* replay)
+	{
+		m_recording = replay;
+	}
+
+	Replay* recording() const
+	{
+		return m_recording;
+	}
+
+	  // put the world back the way it was when the keyframe was taken, so the
+	  // next init() loads the same level in the same state
+	virtual void restoreKeyframe(const Replay::Keyframe& kf)
+	{
+		m_level = kf.level;
+		m_score = kf.score;
+		m_lives = kf.lives;
+	}
+
+	  // a compact copy of the world between ticks, and a way back to it in
+	  // place of init(); a world that can't do this returns false
+	virtual bool saveSnapshot(Snapshot& /* snap */)
+	{
+		return false;
+	}
+
+	virtual bool restoreSnapshot(Snapshot& /* snap */)
+	{
+		return false;
+	}
+
+	  // a copy of the world between ticks that plays on by itself from there,
+	  // for trying out moves; nullptr if this world can't be copied.  A fork
+	  // shares the controller but never records
+	virtual GameWorld* fork()
+	{
+		return nullptr;
+	}
+
+	  // the memory this world holds that it doesn't share with any fork
+	virtual size_t unsharedBytes() const
+	{
+		return 0;
+	}
+
+	  // a 64-bit hash of the whole game state, kept up to date as the world
+	  // changes, so it is cheap to ask for after every tick.  Two worlds in
+	  // the same state have the same hash
+	virtual uint64_t stateHash() const
+	{
+		return 0;
+	}
+
+protected:
+	  // for fork(): everything but the objects, which the fork copies into
+	  // its own set
+	GameWorld(const GameWorld& other)
+	 : m_lives(other.m_lives), m_score(other.m_score), m_level(other.m_level),
+	   m_controller(other.m_controller), m_recording(other.m_recording),
+	   m_assetDir(other.m_assetDir)
+	{
+	}
 	
 private:
 	unsigned int	m_lives;
 	unsigned int	m_score;
 	unsigned int	m_level;
-	GameController* m_controller;
+	WorldController* m_controller;
+	Replay*			m_recording;
 	std::string		m_assetDir;
+	std::set<GraphObject*> m_graphObjects;
+
+	  // Prevent assigning GameWorlds
+	GameWorld& operator=(const GameWorld&);
 };
 
 #endif // GAMEWORLD_H_
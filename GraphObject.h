@@ -19,17 +19,21 @@ class GraphObject
 
 	enum Direction { none, up, down, left, right};
 
-	GraphObject(int imageID, int startX, int startY, Direction dir = none)
+	  // graphObjects is the set of the world the object is in, which the
+	  // framework draws from
+	GraphObject(std::set<GraphObject*>& graphObjects, int imageID, int startX,
+				int startY, Direction dir = none)
 	 : m_imageID(imageID), m_visible(false), m_x(startX), m_y(startY),
 	   m_destX(startX), m_destY(startY), m_brightness(1.0),
-	   m_animationNumber(0), m_direction(dir)
+	   m_animationNumber(0), m_direction(dir), m_graphObjects(nullptr)
 	{
-		getGraphObjects().insert(this);
+		joinGraphObjects(graphObjects);
 	}
 
 	virtual ~GraphObject()
 	{
-		getGraphObjects().erase(this);
+		if (m_graphObjects != nullptr)
+			m_graphObjects->erase(this);
 	}
 
 	void setVisible(bool shouldIDisplay)
@@ -105,10 +109,23 @@ class GraphObject
 		moveALittle(m_y, m_destY);
 	}
 
-	static std::set<GraphObject*>& getGraphObjects()
+  protected:
+	  // Only for copying an object into a forked world.  The copy is in no
+	  // set until the fork hands it its own with joinGraphObjects.
+	GraphObject(const GraphObject& other)
+	 : m_imageID(other.m_imageID), m_visible(other.m_visible), m_x(other.m_x),
+	   m_y(other.m_y), m_destX(other.m_destX), m_destY(other.m_destY),
+	   m_brightness(other.m_brightness), m_animationNumber(other.m_animationNumber),
+	   m_direction(other.m_direction), m_graphObjects(nullptr)
 	{
-		static std::set<GraphObject*> graphObjects;
-		return graphObjects;
+	}
+
+	void joinGraphObjects(std::set<GraphObject*>& graphObjects)
+	{
+		if (m_graphObjects != nullptr)
+			m_graphObjects->erase(this);
+		m_graphObjects = &graphObjects;
+		m_graphObjects->insert(this);
 	}
 
   private:
@@ -121,9 +138,9 @@ class GraphObject
 	double		m_brightness;
 	int			m_animationNumber;
 	Direction	m_direction;
+	std::set<GraphObject*>* m_graphObjects;
 
-	  // Prevent copying or assigning GraphObjects
-	GraphObject(const GraphObject&);
+	  // Prevent assigning GraphObjects
 	GraphObject& operator=(const GraphObject&);
 
 	void moveALittle(double& from, double& to)
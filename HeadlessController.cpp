@@ -0,0 +1,146 @@
+#include "HeadlessController.h"
+#include "GameWorld.h"
+#include "GameConstants.h"
+#include "Replay.h"
+#include "Snapshot.h"
+#include <chrono>
+using namespace std;
+
+static const int NO_KEY = 0;
+
+HeadlessController::HeadlessController(string keyScript)
+ : m_keyScript(keyScript.empty() ? "." : keyScript), m_replay(nullptr),
+   m_nextKey(0), m_lastKeyHit(NO_KEY), m_quit(false)
+{
+}
+
+HeadlessController::HeadlessController(Replay* replay)
+ : m_keyScript("."), m_replay(replay), m_nextKey(0), m_lastKeyHit(NO_KEY),
+   m_quit(false)
+{
+}
+
+bool HeadlessController::getLastKey(int& value)
+{
+	if (m_lastKeyHit != NO_KEY)
+	{
+		value = m_lastKeyHit;
+		m_lastKeyHit = NO_KEY;
+		return true;
+	}
+	return false;
+}
+
+void HeadlessController::feedNextKey()
+{
+	if (m_replay != nullptr)		// recorded keys are already what getKey returned
+	{
+		if (m_replay->finished())
+			m_quit = true;
+		else if (!m_replay->nextKey(m_lastKeyHit))
+			m_lastKeyHit = NO_KEY;
+		return;
+	}
+
+	char key = m_keyScript[m_nextKey];
+	m_nextKey = (m_nextKey + 1) % m_keyScript.size();
+
+	switch (key)
+	{
+		case 'a': case '4': m_lastKeyHit = KEY_PRESS_LEFT;	break;
+		case 'd': case '6': m_lastKeyHit = KEY_PRESS_RIGHT; break;
+		case 'w': case '8': m_lastKeyHit = KEY_PRESS_UP;	break;
+		case 's': case '2': m_lastKeyHit = KEY_PRESS_DOWN;	break;
+		case '.':			m_lastKeyHit = NO_KEY;			break;
+		case 'q': case 'Q': m_quit = true;					break;
+		default:			m_lastKeyHit = key;				break;
+	}
+}
+
+HeadlessController::Report HeadlessController::run(GameWorld* gw, long long maxTicks)
+{
+	if (m_replay != nullptr)
+	{
+		m_replay->rewind();
+		for (unsigned int k = 0; k < m_replay->startLevel(); k++)
+			gw->advanceToNextLevel();
+	}
+
+	return play(gw, maxTicks, false);
+}
+
+HeadlessController::Report HeadlessController::playTo(GameWorld* gw, long long tick)
+{
+	const Replay::Keyframe* kf = m_replay->seek(tick);
+	if (kf == nullptr)			// nothing to start from but the beginning
+		return run(gw, tick);
+
+	if (kf->snapshot.empty())	// a level load, init() rebuilds it from here
+	{
+		gw->restoreKeyframe(*kf);
+		return play(gw, tick - m_replay->position(), false);
+	}
+
+	Snapshot snap;
+	snap.setBytes(kf->snapshot);
+	if (!gw->restoreSnapshot(snap))
+		return run(gw, tick);
+	return play(gw, tick - m_replay->position(), true);
+}
+
+HeadlessController::Report HeadlessController::play(GameWorld* gw, long long maxTicks, bool loaded)
+{
+	gw->setController(this);
+	m_nextKey = 0;
+	m_lastKeyHit = NO_KEY;
+	m_quit = false;
+
+	Report report;
+	report.ticks = 0;
+	report.levelsFinished = 0;
+	report.livesLost = 0;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	  // the same states GameController goes through, minus the prompts and
+	  // the animation frames between ticks
+	int status = (loaded ? GWSTATUS_CONTINUE_GAME : gw->init());
+	report.stateHash = gw->stateHash();
+	while (status != GWSTATUS_PLAYER_WON && status != GWSTATUS_LEVEL_ERROR &&
+		   report.ticks < maxTicks)
+	{
+		feedNextKey();
+		if (m_quit)
+			break;
+
+		status = gw->move();
+		report.ticks++;
+		report.stateHash = gw->stateHash();
+		if (m_quit)		// the world was handed a quit key during the tick
+			break;
+
+		if (status == GWSTATUS_PLAYER_DIED)
+		{
+			report.livesLost++;
+			if (gw->isGameOver())
+				break;
+			gw->cleanUp();
+			status = gw->init();
+		}
+		else if (status == GWSTATUS_FINISHED_LEVEL)
+		{
+			report.levelsFinished++;
+			gw->advanceToNextLevel();
+			gw->cleanUp();
+			status = gw->init();
+		}
+	}
+	gw->cleanUp();
+
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	report.seconds = elapsed.count();
+	report.score = gw->getScore();
+	report.lives = gw->getLives();
+	report.level = gw->getLevel();
+	return report;
+}
@@ -0,0 +1,72 @@
+#ifndef HEADLESSCONTROLLER_H_
+#define HEADLESSCONTROLLER_H_
+
+#include "WorldController.h"
+#include <cstdint>
+#include <string>
+
+class GameWorld;
+class Replay;
+
+  // HeadlessController runs a GameWorld with no window, no timer and no
+  // sound, calling init, move and cleanUp as fast as it can.  Keys come from a
+  // script with one character per tick, read over and over: a, s, d and w (or
+  // 4, 2, 6 and 8) move, '.' is no key at all, q ends the run, and anything
+  // else is passed to the world as it is, just like a key hit in the window.
+  // Given a Replay instead, it starts on the replay's level and plays its keys
+  // back until every recorded tick has been played, or from the replay's
+  // nearest keyframe up to a given tick.
+
+class HeadlessController : public WorldController
+{
+  public:
+	struct Report
+	{
+		long long	ticks;
+		int			levelsFinished;
+		int			livesLost;
+		unsigned int score;			// where the game ended up
+		unsigned int lives;
+		unsigned int level;
+		uint64_t	stateHash;		// GameWorld::stateHash() after the last tick
+		double		seconds;
+
+		double ticksPerSecond() const
+		{
+			return seconds > 0 ? ticks / seconds : 0;
+		}
+	};
+
+	HeadlessController(std::string keyScript = ".");
+	HeadlessController(Replay* replay);
+
+	Report run(GameWorld* gw, long long maxTicks);
+	Report playTo(GameWorld* gw, long long tick);	// replays only, gw must be a new world
+
+	virtual bool getLastKey(int& value);
+
+	virtual void playSound(int /* soundID */)
+	{
+	}
+
+	virtual void setGameStatText(std::string /* text */)
+	{
+	}
+
+	virtual void quitRequested()	// only ever ends this game, never the program
+	{
+		m_quit = true;
+	}
+
+  private:
+	std::string	m_keyScript;
+	Replay*		m_replay;
+	size_t		m_nextKey;
+	int			m_lastKeyHit;
+	bool		m_quit;
+
+	Report play(GameWorld* gw, long long maxTicks, bool loaded);	// loaded: skip init()
+	void feedNextKey();
+};
+
+#endif // HEADLESSCONTROLLER_H_
@@ -0,0 +1,554 @@
+#include "LevelSolver.h"
+#include "Bitboard.h"
+#include "Random.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+  // what never changes while a level is solved
+struct SolverMaze
+{
+	Bitboard	walls;			// walls and factories, nothing ever gets past them
+	Bitboard	fixed;			// goodies and the exit, the player walks over them but boulders can't
+	int			jewelAt[VIEW_HEIGHT][VIEW_WIDTH];	// which bit of SolverState::collected, or -1
+	uint32_t	allJewels;
+	int			exitX;
+	int			exitY;
+};
+
+struct SolverState
+{
+	Bitboard		boulders;
+	Bitboard		holes;			// holes no boulder has filled yet
+	uint32_t		collected;		// one bit per jewel picked up
+	unsigned char	x;				// the player
+	unsigned char	y;
+
+	bool operator==(const SolverState& other) const
+	{
+		return x == other.x && y == other.y && collected == other.collected &&
+			   boulders == other.boulders && holes == other.holes;
+	}
+};
+
+struct SolverStateHash
+{
+	size_t operator()(const SolverState& s) const
+	{
+		uint64_t h = Random::mix(s.collected | uint64_t(s.x) << 32 | uint64_t(s.y) << 40);
+		for (int k = 0; k < BITBOARD_WORDS; k++)
+			h = Random::mix(h ^ s.boulders.word(k) ^ Random::mix(s.holes.word(k)));
+		return static_cast<size_t>(h);
+	}
+};
+
+typedef uint64_t NodeRef;			// shard in the high half, index in the shard in the low half
+static const NodeRef NO_PARENT = ~NodeRef(0);
+
+struct SolverItem
+{
+	SolverState	state;
+	NodeRef		ref;
+	uint32_t	rank;			// its place in its depth, in the order of the moves that reach it
+};
+
+  // Orders the ways into a state at one depth: by the rank of the state moved
+  // from, then by the move's key.  Comparing these is comparing the moves
+  // that lead there as strings, without building them.
+static uint64_t pathKey(uint32_t parentRank, char move)
+{
+	return uint64_t(parentRank) << 8 | static_cast<unsigned char>(move);
+}
+
+  // Every state reached so far, and the move that reached it from which
+  // state, so a solution can be walked back to the start.  Of the ways into
+  // a state at the depth it was first reached, the one with the smallest
+  // pathKey is kept, whichever worker got there first, so every state's
+  // path is its alphabetically first shortest path on any number of threads.
+  // The table is split into shards by hash, each with its own lock, so
+  // workers adding states seldom wait on each other.
+
+class VisitedTable
+{
+  public:
+	VisitedTable()
+	 : m_size(0)
+	{
+	}
+
+	  // false if s was already reached, otherwise ref names its new entry
+	bool insert(const SolverState& s, NodeRef parent, uint64_t key, int depth, NodeRef& ref)
+	{
+		size_t hash = SolverStateHash()(s);
+		unsigned int k = static_cast<unsigned int>(hash >> 8) % SHARDS;
+		Shard& shard = m_shards[k];
+
+		lock_guard<mutex> guard(shard.lock);
+		uint32_t index = static_cast<uint32_t>(shard.nodes.size());
+		pair<unordered_map<SolverState, uint32_t, SolverStateHash>::iterator, bool> found =
+			shard.index.insert(make_pair(s, index));
+		if (!found.second)
+		{
+			Node& node = shard.nodes[found.first->second];
+			if (node.depth == depth && key < node.key)
+			{
+				node.parent = parent;
+				node.key = key;
+			}
+			return false;
+		}
+
+		Node node = { parent, key, depth };
+		shard.nodes.push_back(node);
+		m_size++;
+		ref = NodeRef(k) << 32 | index;
+		return true;
+	}
+
+	long long size() const
+	{
+		return m_size;
+	}
+
+	uint64_t key(NodeRef ref) const		// only once no worker is adding states
+	{
+		return m_shards[ref >> 32].nodes[ref & 0xFFFFFFFF].key;
+	}
+
+	string path(NodeRef ref) const		// only once no worker is adding states
+	{
+		string moves;
+		while (ref != NO_PARENT)
+		{
+			const Node& node = m_shards[ref >> 32].nodes[ref & 0xFFFFFFFF];
+			if (node.parent != NO_PARENT)
+				moves += static_cast<char>(node.key & 0xFF);
+			ref = node.parent;
+		}
+		reverse(moves.begin(), moves.end());
+		return moves;
+	}
+
+  private:
+	static const unsigned int SHARDS = 256;
+
+	struct Node
+	{
+		NodeRef		parent;
+		uint64_t	key;			// pathKey of the move from parent
+		int			depth;
+	};
+
+	struct Shard
+	{
+		mutex lock;
+		unordered_map<SolverState, uint32_t, SolverStateHash> index;
+		vector<Node> nodes;
+	};
+
+	Shard				m_shards[SHARDS];
+	atomic<long long>	m_size;
+};
+
+  // One deque of states per worker for the depth being searched.  A worker
+  // takes from the back of its own deque, and once that is empty steals half
+  // of another worker's from the front.  Nothing is added during a depth, so
+  // a worker that finds every deque empty is done with it.
+
+class StealingQueues
+{
+  public:
+	explicit StealingQueues(int workers)
+	{
+		for (int w = 0; w < workers; w++)
+			m_queues.push_back(unique_ptr<Queue>(new Queue));
+	}
+
+	void deal(vector<SolverItem>& items)	// hands items out round robin, leaving it empty
+	{
+		for (size_t k = 0; k < items.size(); k++)
+			m_queues[k % m_queues.size()]->items.push_back(items[k]);
+		items.clear();
+	}
+
+	bool take(int worker, SolverItem& item)
+	{
+		Queue& own = *m_queues[worker];
+		{
+			lock_guard<mutex> guard(own.lock);
+			if (!own.items.empty())
+			{
+				item = own.items.back();
+				own.items.pop_back();
+				return true;
+			}
+		}
+
+		int n = static_cast<int>(m_queues.size());
+		for (int k = 1; k < n; k++)
+		{
+			Queue& victim = *m_queues[(worker + k) % n];
+			vector<SolverItem> loot;
+			{
+				lock_guard<mutex> guard(victim.lock);
+				size_t half = (victim.items.size() + 1) / 2;
+				loot.assign(victim.items.begin(), victim.items.begin() + half);
+				victim.items.erase(victim.items.begin(), victim.items.begin() + half);
+			}
+			if (loot.empty())
+				continue;
+
+			item = loot.back();
+			loot.pop_back();
+			lock_guard<mutex> guard(own.lock);
+			own.items.insert(own.items.end(), loot.begin(), loot.end());
+			return true;
+		}
+		return false;
+	}
+
+  private:
+	struct Queue
+	{
+		mutex lock;
+		deque<SolverItem> items;
+	};
+
+	vector<unique_ptr<Queue> > m_queues;
+};
+
+  // Holds each worker that reaches wait() until all of them have, then lets
+  // them all go on.  It can be waited at again straight away.
+
+class DepthBarrier
+{
+  public:
+	explicit DepthBarrier(int workers)
+	 : m_workers(workers), m_waiting(0), m_generation(0)
+	{
+	}
+
+	void wait()
+	{
+		unique_lock<mutex> guard(m_lock);
+		unsigned long generation = m_generation;
+		if (++m_waiting == m_workers)
+		{
+			m_waiting = 0;
+			m_generation++;
+			m_released.notify_all();
+		}
+		else
+			m_released.wait(guard, [&]() { return m_generation != generation; });
+	}
+
+  private:
+	mutex				m_lock;
+	condition_variable	m_released;
+	int					m_workers;
+	int					m_waiting;
+	unsigned long		m_generation;
+};
+
+  // false, with the verdict, if the level can't be searched
+static bool buildMaze(const Level& level, SolverMaze& maze, SolverState& start,
+					  LevelSolver::Verdict& verdict)
+{
+	int jewels = 0;
+	bool foundPlayer = false;
+	maze.exitX = maze.exitY = -1;
+	start.collected = 0;
+
+	for (int y = 0; y < VIEW_HEIGHT; y++)
+	{
+		for (int x = 0; x < VIEW_WIDTH; x++)
+		{
+			maze.jewelAt[y][x] = -1;
+			switch (level.getContentsOf(x, y))
+			{
+				case Level::wall:
+				case Level::KleptoBot_factory:
+				case Level::angry_KleptoBot_factory:
+					maze.walls.set(x, y);
+					break;
+				case Level::boulder:
+					start.boulders.set(x, y);
+					break;
+				case Level::hole:
+					start.holes.set(x, y);
+					break;
+				case Level::jewel:
+					if (jewels == LevelSolver::MAX_JEWELS)
+					{
+						verdict = LevelSolver::UNSUPPORTED;
+						return false;
+					}
+					maze.jewelAt[y][x] = jewels++;
+					break;
+				case Level::restore_health:
+				case Level::extra_life:
+				case Level::ammo:
+					maze.fixed.set(x, y);
+					break;
+				case Level::exit:
+					maze.fixed.set(x, y);
+					maze.exitX = x;
+					maze.exitY = y;
+					break;
+				case Level::player:
+					start.x = static_cast<unsigned char>(x);
+					start.y = static_cast<unsigned char>(y);
+					foundPlayer = true;
+					break;
+				default:	// snarlbots and empty spaces
+					break;
+			}
+		}
+	}
+
+	maze.allJewels = (jewels == LevelSolver::MAX_JEWELS ? ~uint32_t(0) : (uint32_t(1) << jewels) - 1);
+	if (!foundPlayer || maze.exitX < 0)
+	{
+		verdict = LevelSolver::NO_SOLUTION;
+		return false;
+	}
+	return true;
+}
+
+static const int DX[4] = { -1, 1, 0, 0 };
+static const int DY[4] = { 0, 0, 1, -1 };
+static const char KEYS[4] = { 'a', 'd', 'w', 's' };
+
+  // True if s can't be finished whatever the player does next.  A boulder
+  // that is held in place both across and up and down by walls or by other
+  // such boulders can never move again.  Treating those as walls and every
+  // other boulder as out of the way, the player must still be able to reach
+  // every jewel left and the exit.
+static bool deadlocked(const SolverMaze& maze, const SolverState& s)
+{
+	Bitboard stuck = maze.walls;
+	Bitboard frozen;
+	for (bool changed = true; changed; )
+	{
+		changed = false;
+		Bitboard loose = s.boulders;
+		for (int i = loose.lowest(); i >= 0; i = loose.lowest())
+		{
+			int x = i % VIEW_WIDTH, y = i / VIEW_WIDTH;
+			loose.reset(x, y);
+			if (frozen.test(x, y))
+				continue;
+			bool across = stuck.test(x - 1, y) || stuck.test(x + 1, y);
+			bool upDown = stuck.test(x, y - 1) || stuck.test(x, y + 1);
+			if (across && upDown)
+			{
+				frozen.set(x, y);
+				stuck.set(x, y);
+				changed = true;
+			}
+		}
+	}
+
+	  // a hole stays unless some boulder is still free to fill it
+	if (s.boulders.count() == frozen.count())
+		stuck |= s.holes;
+
+	Bitboard reached;
+	vector<int> todo(1, Bitboard::index(s.x, s.y));
+	reached.set(s.x, s.y);
+	while (!todo.empty())
+	{
+		int i = todo.back();
+		todo.pop_back();
+		for (int d = 0; d < 4; d++)
+		{
+			int x = i % VIEW_WIDTH + DX[d], y = i / VIEW_WIDTH + DY[d];
+			if (Bitboard::onBoard(x, y) && !stuck.test(x, y) && !reached.test(x, y))
+			{
+				reached.set(x, y);
+				todo.push_back(Bitboard::index(x, y));
+			}
+		}
+	}
+
+	if (!reached.test(maze.exitX, maze.exitY))
+		return true;
+	for (int y = 0; y < VIEW_HEIGHT; y++)
+		for (int x = 0; x < VIEW_WIDTH; x++)
+			if (maze.jewelAt[y][x] >= 0 && !(s.collected >> maze.jewelAt[y][x] & 1) &&
+				!reached.test(x, y))
+				return true;
+	return false;
+}
+
+  // the player's move in direction d, the same way Player and Boulder decide
+  // it in the game.  false if the player can't go that way
+static bool step(const SolverMaze& maze, const SolverState& s, int d, SolverState& next,
+				 bool& pushed)
+{
+	int x = s.x + DX[d], y = s.y + DY[d];
+	if (!Bitboard::onBoard(x, y) || maze.walls.test(x, y) || s.holes.test(x, y))
+		return false;
+
+	next = s;
+	pushed = false;
+	if (s.boulders.test(x, y))
+	{
+		int bx = x + DX[d], by = y + DY[d];
+		if (!Bitboard::onBoard(bx, by))
+			return false;
+		next.boulders.reset(x, y);
+		if (s.holes.test(bx, by))			// the boulder fills the hole and both are gone
+			next.holes.reset(bx, by);
+		else
+		{
+			bool jewelThere = maze.jewelAt[by][bx] >= 0 && !(s.collected >> maze.jewelAt[by][bx] & 1);
+			if (maze.walls.test(bx, by) || maze.fixed.test(bx, by) || s.boulders.test(bx, by) ||
+				jewelThere)
+				return false;
+			next.boulders.set(bx, by);
+			pushed = true;
+		}
+	}
+
+	next.x = static_cast<unsigned char>(x);
+	next.y = static_cast<unsigned char>(y);
+	if (maze.jewelAt[y][x] >= 0)
+		next.collected |= uint32_t(1) << maze.jewelAt[y][x];
+	return true;
+}
+
+LevelSolver::Result LevelSolver::solve(const Level& level)
+{
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+	Result result;
+	result.verdict = NO_SOLUTION;
+	result.states = 0;
+
+	SolverMaze maze;
+	SolverItem root;
+	if (buildMaze(level, maze, root.state, result.verdict))
+	{
+		VisitedTable table;
+		table.insert(root.state, NO_PARENT, 0, 0, root.ref);
+		root.rank = 0;
+
+		vector<SolverItem> frontier(1, root);
+		vector<vector<SolverItem> > nexts(m_threads);
+		StealingQueues queues(m_threads);
+		DepthBarrier barrier(m_threads);
+		vector<NodeRef> goals;
+		mutex goalLock;
+		atomic<bool> full(false);
+		bool done = false;
+		int depth = 0;
+
+		  // One depth at a time, so every state is first reached by a shortest
+		  // path.  Between depths worker 0 gathers what every worker found into
+		  // the next frontier, ranks it and deals it out, while the others wait
+		  // at the barrier.
+		auto search = [&](int w)
+		{
+			for (;;)
+			{
+				if (w == 0)
+				{
+					for (int k = 0; k < m_threads; k++)
+					{
+						frontier.insert(frontier.end(), nexts[k].begin(), nexts[k].end());
+						nexts[k].clear();
+					}
+					if (depth > 0)
+					{
+						sort(frontier.begin(), frontier.end(),
+							 [&](const SolverItem& a, const SolverItem& b)
+							 { return table.key(a.ref) < table.key(b.ref); });
+						for (size_t k = 0; k < frontier.size(); k++)
+							frontier[k].rank = static_cast<uint32_t>(k);
+					}
+					done = frontier.empty() || !goals.empty() || full;
+					depth++;
+					if (!done)
+						queues.deal(frontier);
+				}
+				barrier.wait();
+				if (done)
+					return;
+
+				vector<SolverItem>& next = nexts[w];
+				SolverItem item;
+				while (queues.take(w, item))
+				{
+					for (int d = 0; d < 4; d++)
+					{
+						SolverItem child;
+						bool pushed;
+						if (!step(maze, item.state, d, child.state, pushed))
+							continue;
+
+						bool won = child.state.collected == maze.allJewels &&
+								   child.state.x == maze.exitX && child.state.y == maze.exitY;
+						if (!won && pushed && deadlocked(maze, child.state))
+							continue;
+						if (!table.insert(child.state, item.ref, pathKey(item.rank, KEYS[d]), depth,
+										  child.ref))
+							continue;
+
+						if (won)
+						{
+							lock_guard<mutex> guard(goalLock);
+							goals.push_back(child.ref);
+						}
+						else
+							next.push_back(child);
+					}
+					if (table.size() > m_maxStates)
+					{
+						full = true;
+						break;
+					}
+				}
+				barrier.wait();
+			}
+		};
+
+		  // the workers last the whole search; this thread is worker 0
+		vector<thread> workers;
+		for (int w = 1; w < m_threads; w++)
+			workers.push_back(thread(search, w));
+		search(0);
+		for (size_t w = 0; w < workers.size(); w++)
+			workers[w].join();
+
+		  // Once the table is full the last depth was cut short, and which of
+		  // its solutions were found depends on the threads, so none count.
+		  // Otherwise the goal with the smallest key has the alphabetically
+		  // first shortest solution, the same on any number of threads.
+		if (full)
+			result.verdict = GAVE_UP;
+		else if (!goals.empty())
+		{
+			NodeRef best = goals[0];
+			for (size_t k = 1; k < goals.size(); k++)
+				if (table.key(goals[k]) < table.key(best))
+					best = goals[k];
+			result.moves = table.path(best);
+			result.verdict = SOLVED;
+		}
+		result.states = table.size();
+	}
+
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+	result.seconds = elapsed.count();
+	return result;
+}
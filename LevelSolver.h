@@ -0,0 +1,52 @@
+#ifndef LEVELSOLVER_H_
+#define LEVELSOLVER_H_
+
+#include "Level.h"
+#include <string>
+
+  // LevelSolver checks offline that a level can be finished: that the player
+  // can collect every jewel and then reach the exit, pushing boulders and
+  // filling holes on the way.  It searches breadth first, one move deeper at
+  // a time, so the solution it reports is a shortest one; of those it is
+  // always the alphabetically first key script, whatever the number of
+  // threads.  The moves of each depth are spread over worker threads that
+  // steal from each other once their own share runs out, and every state
+  // reached is kept in a table shared by all of them so no state is searched
+  // twice.
+  //
+  // Only the maze itself is solved.  Robots are left out, their factories
+  // count as walls, and the player never fires.  Goodies are never picked up,
+  // so they block boulders for good.  A solution it finds works in the maze
+  // without its robots; in the game robots can stand in the way or shoot the
+  // player, so a level that is solved can still be lost.  A level that needs
+  // a shot or a goodie out of the way is reported unsolved.  A level with
+  // more than MAX_JEWELS jewels is not searched at all.
+
+class LevelSolver
+{
+  public:
+	enum Verdict { SOLVED, NO_SOLUTION, GAVE_UP, UNSUPPORTED };
+
+	static const int MAX_JEWELS = 32;	// one bit each in a search state
+
+	struct Result
+	{
+		Verdict		verdict;
+		std::string	moves;			// a HeadlessController key script, one move per key
+		long long	states;			// distinct states reached
+		double		seconds;
+	};
+
+	LevelSolver(int threads, long long maxStates = 5000000)
+	 : m_threads(threads < 1 ? 1 : threads), m_maxStates(maxStates)
+	{
+	}
+
+	Result solve(const Level& level);	// GAVE_UP once more than maxStates are reached
+
+  private:
+	int			m_threads;
+	long long	m_maxStates;
+};
+
+#endif // LEVELSOLVER_H_
@@ -0,0 +1,78 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+// Random is a small, fast generator (xoshiro128**) with a state of four 32-bit words.  Each world
+// owns one, so worlds never share random numbers, and the same seed always gives the same
+// sequence on every platform, unlike rand().  The seed is spread over the state with splitmix64,
+// so nearby seeds still give unrelated sequences.
+
+class Random
+{
+public:
+    explicit Random(uint64_t seed = 0)
+    {
+        setSeed(seed);
+    }
+
+    void setSeed(uint64_t seed)
+    {
+        for (int k = 0; k < 4; k += 2)
+        {
+            uint64_t z = mix(seed += 0x9E3779B97F4A7C15ULL);
+            m_state[k] = static_cast<uint32_t>(z);
+            m_state[k + 1] = static_cast<uint32_t>(z >> 32);
+        }
+    }
+
+    void getState(uint32_t state[4]) const
+    {
+        for (int k = 0; k < 4; k++)
+            state[k] = m_state[k];
+    }
+
+    void setState(const uint32_t state[4])
+    {
+        for (int k = 0; k < 4; k++)
+            m_state[k] = state[k];
+    }
+
+    uint32_t next()
+    {
+        uint32_t result = rotl(m_state[1] * 5, 7) * 9;
+        uint32_t t = m_state[1] << 9;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 11);
+
+        return result;
+    }
+
+    int randInt(int min, int max)       //a number from min to max, both included
+    {
+        uint32_t range = static_cast<uint32_t>(max - min) + 1;
+        return min + static_cast<int>((static_cast<uint64_t>(next()) * range) >> 32);
+    }
+
+    static uint64_t mix(uint64_t z)     //splitmix64's finalizer, every input bit affects every output bit
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint32_t m_state[4];
+
+    static uint32_t rotl(uint32_t x, int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+};
+
+#endif // RANDOM_H_
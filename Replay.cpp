@@ -0,0 +1,277 @@
+#include "Replay.h"
+#include "GameConstants.h"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+using namespace std;
+
+static const char REPLAY_MAGIC[4] = { 'B', 'B', 'R', 'P' };
+static const char INDEX_MAGIC[4] = { 'B', 'B', 'K', 'I' };
+static const unsigned char REPLAY_VERSION = 3;
+
+static unsigned int encodeKey(int key)      //the arrow keys become 0 to 3 so every common key fits
+{                                           //in one byte, anything else is shifted past them
+    if (key >= KEY_PRESS_LEFT && key <= KEY_PRESS_DOWN)
+        return key - KEY_PRESS_LEFT;
+    return key + 4;
+}
+
+static int decodeKey(unsigned long long code)
+{
+    if (code < 4)
+        return KEY_PRESS_LEFT + static_cast<int>(code);
+    return static_cast<int>(code - 4);
+}
+
+Replay::Replay(unsigned int seed, unsigned int startLevel)
+ : m_seed(seed), m_startLevel(startLevel), m_ticks(0), m_nextTick(0), m_nextKey(0)
+{}
+
+void Replay::recordKey(bool gotKey, int key)
+{
+    if (gotKey)
+    {
+        KeyPress press = { m_ticks, key };
+        m_keys.push_back(press);
+    }
+    m_ticks++;
+}
+
+void Replay::addKeyframe(Keyframe kf)
+{
+    kf.tick = m_ticks;
+    kf.keyIndex = m_keys.size();    //no key can be at or after this tick yet
+    
+    if (!m_keyframes.empty() && m_keyframes.back().tick == kf.tick)
+        m_keyframes.back() = kf;    //a level loaded without a tick played since, keep the later one
+    else
+        m_keyframes.push_back(kf);
+}
+
+bool Replay::snapshotDue() const
+{
+    if (m_ticks == 0 || m_ticks % SNAPSHOT_INTERVAL != 0)
+        return false;
+    return m_keyframes.empty() || m_keyframes.back().tick != m_ticks;     //not if a level just loaded
+}
+
+bool Replay::save(const string& path) const
+{
+    vector<unsigned char> out(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    out.push_back(REPLAY_VERSION);
+    putVarint(out, m_seed);
+    putVarint(out, m_startLevel);
+    putVarint(out, m_ticks);
+    putVarint(out, m_keys.size());
+    
+    long long lastTick = -1;
+    for (size_t k = 0; k < m_keys.size(); k++)
+    {
+        putVarint(out, m_keys[k].tick - lastTick - 1);      //idle ticks since the last key
+        putVarint(out, encodeKey(m_keys[k].key));
+        lastTick = m_keys[k].tick;
+    }
+    
+    uint64_t indexOffset = out.size();
+    putVarint(out, m_keyframes.size());
+    for (size_t k = 0; k < m_keyframes.size(); k++)
+    {
+        const Keyframe& kf = m_keyframes[k];
+        putVarint(out, kf.tick);
+        putVarint(out, kf.keyIndex);
+        putVarint(out, kf.level);
+        putVarint(out, kf.score);
+        putVarint(out, kf.lives);
+        for (int w = 0; w < 4; w++)
+            putVarint(out, kf.random[w]);
+        putVarint(out, kf.snapshot.size());
+        out.insert(out.end(), kf.snapshot.begin(), kf.snapshot.end());
+    }
+    
+    for (int b = 0; b < 8; b++)
+        out.push_back(static_cast<unsigned char>(indexOffset >> (8 * b)));
+    out.insert(out.end(), INDEX_MAGIC, INDEX_MAGIC + 4);
+    
+    ofstream file(path.c_str(), ios::binary);
+    file.write(reinterpret_cast<const char*>(&out[0]), out.size());
+    return file.good();
+}
+
+bool Replay::load(const string& path)
+{
+    ifstream file(path.c_str(), ios::binary);
+    if (!file)
+        return false;
+    vector<unsigned char> in((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    
+    if (in.size() < 5 + 12 || !equal(REPLAY_MAGIC, REPLAY_MAGIC + 4, in.begin()) ||
+        in[4] != REPLAY_VERSION || !equal(INDEX_MAGIC, INDEX_MAGIC + 4, in.end() - 4))
+        return false;
+    
+    size_t footer = in.size() - 12;
+    uint64_t indexOffset = 0;
+    for (int b = 0; b < 8; b++)
+        indexOffset |= static_cast<uint64_t>(in[footer + b]) << (8 * b);
+    if (indexOffset > footer)
+        return false;
+    
+    size_t pos = 5;
+    unsigned long long seed, startLevel, ticks, keyCount;
+    if (!getVarint(in, pos, seed) || !getVarint(in, pos, startLevel) || !getVarint(in, pos, ticks) ||
+        !getVarint(in, pos, keyCount))
+        return false;
+    
+    vector<KeyPress> keys;
+    long long lastTick = -1;
+    for (unsigned long long k = 0; k < keyCount; k++)
+    {
+        unsigned long long idle, key;
+        if (!getVarint(in, pos, idle) || !getVarint(in, pos, key))
+            return false;
+        
+        KeyPress press = { lastTick + 1 + static_cast<long long>(idle), decodeKey(key) };
+        if (press.tick >= static_cast<long long>(ticks))      //a key past the end, the file is damaged
+            return false;
+        keys.push_back(press);
+        lastTick = press.tick;
+    }
+    
+    pos = indexOffset;
+    unsigned long long keyframeCount;
+    if (!getVarint(in, pos, keyframeCount))
+        return false;
+    
+    vector<Keyframe> keyframes;
+    for (unsigned long long k = 0; k < keyframeCount; k++)
+    {
+        unsigned long long v[9];
+        for (int f = 0; f < 9; f++)
+            if (!getVarint(in, pos, v[f]))
+                return false;
+        
+        Keyframe kf;
+        kf.tick = static_cast<long long>(v[0]);
+        kf.keyIndex = v[1];
+        kf.level = static_cast<unsigned int>(v[2]);
+        kf.score = static_cast<unsigned int>(v[3]);
+        kf.lives = static_cast<unsigned int>(v[4]);
+        for (int w = 0; w < 4; w++)
+            kf.random[w] = static_cast<uint32_t>(v[5 + w]);
+        
+        unsigned long long snapshotSize;
+        if (!getVarint(in, pos, snapshotSize) || pos > footer || snapshotSize > footer - pos)
+            return false;       //the varints ran into the footer, or the Snapshot would
+        kf.snapshot.assign(in.begin() + pos, in.begin() + pos + snapshotSize);
+        pos += snapshotSize;
+        
+        if (kf.tick > static_cast<long long>(ticks) || kf.keyIndex > keys.size())
+            return false;
+        keyframes.push_back(kf);
+    }
+    
+    m_seed = static_cast<unsigned int>(seed);
+    m_startLevel = static_cast<unsigned int>(startLevel);
+    m_ticks = static_cast<long long>(ticks);
+    m_keys.swap(keys);
+    m_keyframes.swap(keyframes);
+    rewind();
+    return true;
+}
+
+void Replay::rewind()
+{
+    m_nextTick = 0;
+    m_nextKey = 0;
+}
+
+const Replay::Keyframe* Replay::seek(long long tick)
+{
+    //the last Keyframe at or before tick, found by binary search
+    const Keyframe* best = nullptr;
+    size_t low = 0, high = m_keyframes.size();
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (m_keyframes[mid].tick <= tick)
+        {
+            best = &m_keyframes[mid];
+            low = mid + 1;
+        }
+        else
+            high = mid;
+    }
+    
+    if (best == nullptr)
+    {
+        rewind();
+        return nullptr;
+    }
+    
+    m_nextTick = best->tick;
+    m_nextKey = best->keyIndex;
+    return best;
+}
+
+bool Replay::nextKey(int& key)
+{
+    long long tick = m_nextTick++;
+    if (m_nextKey < m_keys.size() && m_keys[m_nextKey].tick == tick)
+    {
+        key = m_keys[m_nextKey++].key;
+        return true;
+    }
+    return false;
+}
+
+bool Replay::finished() const
+{
+    return m_nextTick >= m_ticks;
+}
+
+unsigned int Replay::seed() const
+{
+    return m_seed;
+}
+
+unsigned int Replay::startLevel() const
+{
+    return m_startLevel;
+}
+
+long long Replay::ticks() const
+{
+    return m_ticks;
+}
+
+long long Replay::position() const
+{
+    return m_nextTick;
+}
+
+const vector<Replay::Keyframe>& Replay::keyframes() const
+{
+    return m_keyframes;
+}
+
+void Replay::putVarint(vector<unsigned char>& out, unsigned long long value)
+{
+    while (value >= 0x80)       //seven bits at a time, low bits first, the high bit means more follow
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+bool Replay::getVarint(const vector<unsigned char>& in, size_t& pos, unsigned long long& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+        unsigned char byte = in[pos++];
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;       //ran off the end of the data
+}
@@ -0,0 +1,85 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A Replay is everything needed to play a game again exactly: the world's random seed, the level
+// it started on, and the key (or lack of one) GameWorld::getKey returned on every tick.  The player
+// asks for exactly one key per tick, so the n-th key asked for is the n-th tick's key.
+//
+// A Replay also keeps a Keyframe each time the world loads a level, at the start and after every
+// lost life.  The whole world then comes from the level file, the random generator, and the
+// level, score and lives, so those few numbers are enough to rebuild it.  In between, it keeps a
+// Keyframe with a full world Snapshot every SNAPSHOT_INTERVAL ticks.  Playing from tick N
+// restores the last Keyframe at or before N and simulates only the ticks after it.
+//
+// On disk a Replay is:
+//      "BBRP", a version byte, then the seed, start level, tick count and key count as varints
+//      one pair of varints for each tick that had a key: the idle ticks before it, then the key
+//      the Keyframe count, then each Keyframe as varints, including the index of its first key,
+//      ending with the length of its Snapshot and the Snapshot itself
+//      an 8-byte little-endian offset of the Keyframe count, then "BBKI"
+// so a reader can find the Keyframes from the end of the file without decoding the keys.
+
+class Replay
+{
+public:
+    struct Keyframe
+    {
+        long long tick = 0;     //the first tick played after the level was loaded
+        unsigned int level = 0;
+        unsigned int score = 0;
+        unsigned int lives = 0;
+        uint32_t random[4] = { 0, 0, 0, 0 };    //the world's generator just before the level was loaded
+        
+        size_t keyIndex = 0;    //the first key at or after tick
+        
+        std::vector<unsigned char> snapshot;    //empty if the Keyframe is a level load
+    };
+    
+    static const int SNAPSHOT_INTERVAL = 1024;
+    
+    Replay(unsigned int seed = 0, unsigned int startLevel = 0);
+    
+    //recording
+    void recordKey(bool gotKey, int key);       //called once per tick, by GameWorld::getKey
+    void addKeyframe(Keyframe kf);              //called by the world as it loads a level
+    bool snapshotDue() const;                   //time for a Keyframe with a Snapshot
+    bool save(const std::string& path) const;
+    
+    //playing back
+    bool load(const std::string& path);
+    void rewind();
+    const Keyframe* seek(long long tick);      //the Keyframe play resumes from, nullptr if none
+    bool nextKey(int& key);     //the next tick's key, false if it had none
+    bool finished() const;      //every recorded tick has been played
+    long long position() const; //the next tick to be played
+    
+    unsigned int seed() const;
+    unsigned int startLevel() const;
+    long long ticks() const;
+    const std::vector<Keyframe>& keyframes() const;
+    
+    static void putVarint(std::vector<unsigned char>& out, unsigned long long value);
+    static bool getVarint(const std::vector<unsigned char>& in, size_t& pos, unsigned long long& value);
+    
+private:
+    struct KeyPress
+    {
+        long long tick;
+        int key;
+    };
+    
+    unsigned int m_seed;
+    unsigned int m_startLevel;
+    long long m_ticks;
+    std::vector<KeyPress> m_keys;           //in tick order
+    std::vector<Keyframe> m_keyframes;      //in tick order
+    
+    long long m_nextTick;   //playback position
+    size_t m_nextKey;
+};
+
+#endif // REPLAY_H_
@@ -0,0 +1,272 @@
+#include "SimBench.h"
+#include "StudentWorld.h"
+#include "HeadlessController.h"
+#include "Random.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+using namespace std;
+
+#ifdef SIMBENCH_ALLOCATIONS
+
+  // every heap allocation made through new, counted per thread so the games
+  // --batch plays side by side don't fight over the count
+static thread_local unsigned long long allocationCount = 0;
+
+static void* allocate(size_t size)
+{
+	allocationCount++;
+	for (;;)
+	{
+		void* p = malloc(size == 0 ? 1 : size);
+		if (p != nullptr)
+			return p;
+		new_handler handler = get_new_handler();
+		if (handler == nullptr)
+			throw bad_alloc();
+		handler();
+	}
+}
+
+void* operator new(size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t /* size */) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t /* size */) noexcept
+{
+	free(p);
+}
+
+#ifdef __cpp_aligned_new
+
+static void* allocateAligned(size_t size, align_val_t alignment)
+{
+	allocationCount++;
+	size_t align = static_cast<size_t>(alignment);
+	size = (size == 0 ? align : (size + align - 1) / align * align);	// aligned_alloc wants a multiple
+	for (;;)
+	{
+		void* p = aligned_alloc(align, size);
+		if (p != nullptr)
+			return p;
+		new_handler handler = get_new_handler();
+		if (handler == nullptr)
+			throw bad_alloc();
+		handler();
+	}
+}
+
+void* operator new(size_t size, align_val_t alignment)
+{
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, align_val_t alignment)
+{
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p, align_val_t /* alignment */) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, align_val_t /* alignment */) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t /* size */, align_val_t /* alignment */) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t /* size */, align_val_t /* alignment */) noexcept
+{
+	free(p);
+}
+
+#endif // __cpp_aligned_new
+
+const bool SimBench::countsAllocations = true;
+
+static unsigned long long allocationsSoFar()
+{
+	return allocationCount;
+}
+
+#else
+
+const bool SimBench::countsAllocations = false;
+
+static unsigned long long allocationsSoFar()
+{
+	return 0;
+}
+
+#endif // SIMBENCH_ALLOCATIONS
+
+static double chance(Random& random)	// from 0 up to, not including, 1
+{
+	return random.next() / 4294967296.0;
+}
+
+  // the player's corner, walled off from the rest of the board
+static const int PLAYER_X = 1;
+static const int PLAYER_Y = VIEW_HEIGHT - 2;
+
+bool SimBench::writeLevel(const Board& board)
+{
+	Random random(m_seed);
+	char maze[VIEW_HEIGHT][VIEW_WIDTH];		// indexed the way the game does, y = 0 is the bottom row
+	for (int y = 0; y < VIEW_HEIGHT; y++)
+	{
+		for (int x = 0; x < VIEW_WIDTH; x++)
+		{
+			double roll = chance(random);
+			char c = ' ';
+			if (x == 0 || y == 0 || x == VIEW_WIDTH - 1 || y == VIEW_HEIGHT - 1)
+				c = '#';
+			else if ((roll -= board.walls) < 0)
+				c = '#';
+			else if ((roll -= board.snarlBots) < 0)
+				c = (random.randInt(0, 1) == 0 ? 'h' : 'v');
+			else if ((roll -= board.factories) < 0)
+				c = (random.randInt(0, 1) == 0 ? '1' : '2');
+			else if ((roll -= board.pickups) < 0)
+				c = "*rea"[random.randInt(0, 3)];
+			maze[y][x] = c;
+		}
+	}
+
+	maze[PLAYER_Y][PLAYER_X] = '@';
+	maze[PLAYER_Y][PLAYER_X + 1] = '#';
+	maze[PLAYER_Y - 1][PLAYER_X] = '#';
+	maze[1][VIEW_WIDTH - 2] = 'x';
+
+	string path = m_scratchDir;
+	if (!path.empty())
+		path += '/';
+	ofstream out((path + "level00.dat").c_str());
+	for (int y = VIEW_HEIGHT - 1; y >= 0; y--)
+		out << string(maze[y], VIEW_WIDTH) << '\n';
+	return static_cast<bool>(out);
+}
+
+bool SimBench::run(const Board& board, Result& result)
+{
+	if (!writeLevel(board))
+		return false;
+
+	StudentWorld world(m_scratchDir, m_seed);
+	HeadlessController controller;		// never fed a key, so the player stands still
+	world.setController(&controller);
+	if (world.init() != GWSTATUS_CONTINUE_GAME)
+	{
+		world.cleanUp();
+		return false;
+	}
+
+	Random random(m_seed + 1);
+	for (int y = 1; y < VIEW_HEIGHT - 1; y++)
+		for (int x = 1; x < VIEW_WIDTH - 1; x++)
+			if (world.spaceContains(x, y) == nullptr && world.checkPlayer(x, y) &&
+				chance(random) < board.kleptoBots)
+				world.addKleptoBot(x, y, random.randInt(0, 1) == 0 ? 10 : 20);
+
+	static const GraphObject::Direction DIRECTIONS[4] =
+		{ GraphObject::up, GraphObject::down, GraphObject::left, GraphObject::right };
+
+	chrono::steady_clock::duration inMove(0);
+	long long actorTicks = 0;
+	unsigned long long allocations = 0;
+	long long ticks = 0;
+	while (ticks < m_ticks)
+	{
+		  // bullets only go where a Player or robot could have fired one
+		for (int tries = 0, fired = 0; fired < board.bulletsPerTick && tries < 4 * board.bulletsPerTick; tries++)
+		{
+			int x = random.randInt(1, VIEW_WIDTH - 2), y = random.randInt(1, VIEW_HEIGHT - 2);
+			if (world.spaceContains(x, y) == nullptr && world.checkPlayer(x, y))
+			{
+				world.addBullet(x, y, DIRECTIONS[random.randInt(0, 3)]);
+				fired++;
+			}
+		}
+
+		actorTicks += world.getActorStore().size();
+		unsigned long long allocated = allocationsSoFar();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		int status = world.move();
+		inMove += chrono::steady_clock::now() - start;
+		allocations += allocationsSoFar() - allocated;
+		ticks++;
+
+		if (status != GWSTATUS_CONTINUE_GAME)	// the player is out of reach, but just in case
+			break;
+	}
+	result.profile = world.profile();
+	world.cleanUp();
+
+	result.name = board.name;
+	result.ticks = ticks;
+	result.seconds = chrono::duration<double>(inMove).count();
+	result.actors = ticks > 0 ? double(actorTicks) / ticks : 0;
+	result.nsPerActorTick = actorTicks > 0 ? result.seconds * 1e9 / actorTicks : 0;
+	result.allocationsPerTick = ticks > 0 ? double(allocations) / ticks : 0;
+	return true;
+}
+
+vector<SimBench::Board> SimBench::standardBoards()
+{
+	  // name, walls, SnarlBots, factories, pickups, KleptoBots, bullets per tick
+	static const Board BOARDS[] =
+	{
+		{ "empty",		0,		0,		0,		0,		0,		0 },
+		{ "walls",		0.5,	0,		0,		0,		0,		0 },
+		{ "snarlbots",	0.05,	0.15,	0,		0,		0,		0 },
+		{ "kleptobots",	0.05,	0,		0,		0.1,	0.15,	0 },
+		{ "factories",	0.05,	0,		0.1,	0.1,	0,		0 },
+		{ "bullets",	0.05,	0,		0,		0,		0,		4 },
+		{ "pickups",	0.05,	0,		0,		0.4,	0,		0 },
+		{ "mixed",		0.15,	0.05,	0.03,	0.1,	0.05,	1 },
+		{ "crowded",	0.1,	0.15,	0.08,	0.2,	0.15,	3 },
+	};
+	return vector<Board>(BOARDS, BOARDS + sizeof(BOARDS) / sizeof(BOARDS[0]));
+}
+
+void SimBench::writeCsv(ostream& out, const vector<Result>& results)
+{
+	out << "board,ticks,actors,seconds,ns_per_actor_tick,allocations_per_tick\n";
+	for (size_t k = 0; k < results.size(); k++)
+	{
+		const Result& r = results[k];
+		out << r.name << ',' << r.ticks << ',' << r.actors << ',' << r.seconds << ','
+			<< r.nsPerActorTick << ',';
+		if (countsAllocations)
+			out << r.allocationsPerTick;
+		out << '\n';
+	}
+}
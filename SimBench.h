@@ -0,0 +1,67 @@
+#ifndef SIMBENCH_H_
+#define SIMBENCH_H_
+
+#include "TickProfile.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+  // SimBench times StudentWorld::move on synthetic boards, so a change that
+  // slows the tick down shows up as a number that moved.  Each board is
+  // written out as a level file with walls, SnarlBots, factories and pickups
+  // scattered at the densities asked for.  KleptoBots are added once the
+  // level is loaded, and bullets are fired into it before every tick, since a
+  // level file can't hold either.  The player is walled into a corner where
+  // nothing can reach, so a run never ends early.
+  //
+  // Only the time spent inside move() counts, and so do only the heap
+  // allocations made by the thread running it.  Allocations are counted only
+  // when SIMBENCH_ALLOCATIONS is defined, since that replaces the global
+  // operator new for the whole program.
+
+class SimBench
+{
+  public:
+	struct Board
+	{
+		std::string	name;
+		double		walls;			// the chance each free space gets one of these
+		double		snarlBots;
+		double		factories;
+		double		pickups;		// jewels and goodies
+		double		kleptoBots;
+		int			bulletsPerTick;
+	};
+
+	struct Result
+	{
+		std::string	name;
+		long long	ticks;
+		double		actors;			// on average, at the start of a tick
+		double		seconds;		// inside move()
+		double		nsPerActorTick;
+		double		allocationsPerTick;	// 0 unless countsAllocations
+		TickProfile	profile;		// the world's own breakdown of the same ticks
+	};
+
+	SimBench(std::string scratchDir, long long ticks, unsigned int seed = 0)
+	 : m_scratchDir(scratchDir), m_ticks(ticks), m_seed(seed)
+	{
+	}
+
+	bool run(const Board& board, Result& result);	// false if the board can't be written or loaded
+
+	static const bool countsAllocations;
+
+	static std::vector<Board> standardBoards();
+	static void writeCsv(std::ostream& out, const std::vector<Result>& results);
+
+  private:
+	std::string		m_scratchDir;	// where the board is written, as level00.dat
+	long long		m_ticks;
+	unsigned int	m_seed;			// the same seed builds the same boards and plays the same ticks
+
+	bool writeLevel(const Board& board);
+};
+
+#endif // SIMBENCH_H_
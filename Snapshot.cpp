@@ -0,0 +1,45 @@
+#include "Snapshot.h"
+#include "Replay.h"
+using namespace std;
+
+void Snapshot::put(unsigned long long value)
+{
+    Replay::putVarint(m_bytes, value);
+}
+
+void Snapshot::putInt(int value)
+{
+    unsigned int u = static_cast<unsigned int>(value);
+    put((u << 1) ^ (value < 0 ? ~0u : 0u));
+}
+
+bool Snapshot::get(unsigned long long& value)
+{
+    return Replay::getVarint(m_bytes, m_pos, value);
+}
+
+bool Snapshot::getInt(int& value)
+{
+    unsigned int u;
+    if (!getUnsigned(u))
+        return false;
+    value = static_cast<int>((u >> 1) ^ (0u - (u & 1)));
+    return true;
+}
+
+void Snapshot::clear()
+{
+    m_bytes.clear();
+    m_pos = 0;
+}
+
+void Snapshot::rewind()
+{
+    m_pos = 0;
+}
+
+void Snapshot::setBytes(const vector<unsigned char>& bytes)
+{
+    m_bytes = bytes;
+    m_pos = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <string>
+#include <vector>
+
+// A Snapshot is a compact binary copy of a world between ticks.  Every number goes in as a varint,
+// so the small values a board is made of (coordinates, hit points, counters) mostly take a byte
+// each.  Values are read back in the order they were written.
+
+class Snapshot
+{
+public:
+    Snapshot()
+     : m_pos(0)
+    {}
+    
+    void put(unsigned long long value);
+    void putInt(int value);             //zigzag encoded, so small negative numbers stay small too
+    bool get(unsigned long long& value);
+    bool getInt(int& value);
+    
+    template<typename T>
+    bool getUnsigned(T& value)          //reads a value put() from a T, false if it doesn't fit
+    {
+        unsigned long long v;
+        if (!get(v) || v != static_cast<unsigned long long>(static_cast<T>(v)))
+            return false;
+        value = static_cast<T>(v);
+        return true;
+    }
+    
+    void clear();
+    void rewind();      //read from the start again
+    
+    const std::vector<unsigned char>& bytes() const
+    {
+        return m_bytes;
+    }
+    
+    void setBytes(const std::vector<unsigned char>& bytes);
+    
+private:
+    std::vector<unsigned char> m_bytes;
+    size_t m_pos;       //where the next value is read from
+};
+
+#endif // SNAPSHOT_H_
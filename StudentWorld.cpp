@@ -1,40 +1,98 @@
 #include "StudentWorld.h"
+#include "Trace.h"
 #include "GameWorld.h"
 #include "GameConstants.h"
 #include "Level.h"
+#include "Snapshot.h"
 #include <string>
 #include <sstream>
-#include <list>
 #include <iomanip>
+#include <algorithm>
+#include <climits>
 using namespace std;
 
+static const int BEFORE_NEXT_TICK = INT_MAX;     //m_passSlot once the tick's pass is over
+
+static bool actsEveryTick(int kind)     //robots wait for their turn between moves, holes wait for a
+{                                       //boulder and pickups wait for the player
+    return kind == IID_ROBOT_FACTORY || kind == IID_BULLET;
+}
+
+static const unsigned int SNAPSHOT_VERSION = 1;
+
+static bool neverActs(int kind)     //these Actors are still in the spatial index and still drawn,
+{                                   //but their doSomething() is never needed
+    return kind == IID_WALL || kind == IID_BOULDER || kind == IID_PLAYER;
+}
+
 StudentWorld::~StudentWorld()
 {
     cleanUp();              //cleanup function and destructor do the same thing essentially
 }
 
-GameWorld* createStudentWorld(string assetDir)
+GameWorld* createStudentWorld(string assetDir, unsigned int seed)
 {
-	return new StudentWorld(assetDir);
+	return new StudentWorld(assetDir, seed);
 }
 
 
 
 int StudentWorld::init()
+{
+    TRACE_ZONE("StudentWorld::init");
+    if (recording() != nullptr)     //a recorded game can restart from any level load
+        addKeyframe(false);
+    
+    resetState();
+    return loadLevel();
+}
+
+void StudentWorld::resetState()     //everything init() needs before a level's Actors are added
 {
     m_bonus = 1000;             //Start of each level, bonus must be 1000
     nJewel = 0;                 // 0 jewels until added by loadLevel()
     revealed = false;           //exit isn't revealed yet
     levelComplete = false;      //level has not been completed
+    m_nextSerial = 0;           //serials give each Actor its position in the list
+    m_actorHash = 0;
+    m_now = 0;                  //Actors loaded now first act on tick 1
+    m_passSlot = BEFORE_NEXT_TICK;
+    m_wheel.clear();
+    m_awake.clear();
     
-    return loadLevel();
+    for (int y = 0; y < VIEW_HEIGHT; y++)       //no KleptoBots or registered Actors until loadLevel()
+    {
+        for (int x = 0; x < VIEW_WIDTH; x++)
+        {
+            m_kleptoCount[y][x] = 0;
+            m_boulderAt[y][x] = ActorHandle();
+            m_holeAt[y][x] = ActorHandle();
+        }
+    }
+    m_stealableAt.fill(vector<ActorHandle>());
+    m_triggers.fill(vector<ActorHandle>());
+    m_exits.clear();
+    m_kleptoSumsValid = false;
 }
 
 int StudentWorld::move()
 {
+    TRACE_ZONE("StudentWorld::move");
     setTopDisplay();        //Update the top screen;
     
-    player->doSomething();
+    if (recording() != nullptr && recording()->snapshotDue())
+        addKeyframe(true);  //long levels get a keyframe every so often too
+    
+    m_now++;
+    PROFILE_TICK(m_profile);
+    startTick();            //find who acts this tick before anything else can be added
+    
+    {
+        TRACE_ZONE("player");
+        PROFILE_SCOPE(m_profile, IID_PLAYER);
+        player->doSomething();
+        rehash(player);     //its direction and ammo change on its own turn
+    }
     
     if (!player->isAlive())     //if the player dies, immediately decrease lives and return
     {
@@ -45,9 +103,20 @@ int StudentWorld::move()
     if (levelComplete)
         return GWSTATUS_FINISHED_LEVEL;
     
-    for (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
+    //one pass over the Actors whose turn it is, in list order.  Actors added during the pass (bullets,
+    //KleptoBots) are reached in the same tick, just as they were at the end of the list
+    TraceZone actorPass("actor pass");
+    for (size_t k = 0; k < m_awake.size(); k++)
     {
-        (*p)->doSomething();        //loop through all actors and call their doSomething() function
+        int slot = m_awake[k];
+        m_passSlot = slot;
+        
+        Actor* act = m_store.actor(slot);
+        {
+            PROFILE_SCOPE(m_profile, m_store.kind(slot));
+            act->doSomething();     //call each awake actor's doSomething() function
+            rehash(act);
+        }
         
         if (!player->isAlive())     //ensure player is still alive
         {
@@ -55,7 +124,12 @@ int StudentWorld::move()
             return  GWSTATUS_PLAYER_DIED;
         }
         
+        if (actsEveryTick(m_store.kind(slot)))
+            scheduleTurn(act, 1);       //robots reschedule themselves with setTick()
     }
+    actorPass.end();
+    m_passSlot = BEFORE_NEXT_TICK;
+    
     removeDead();       //remove actors that died on the current tick
     m_bonus--;
     
@@ -71,17 +145,29 @@ int StudentWorld::move()
 
 void StudentWorld::cleanUp()        //used to delete dynamically allocated actors and erase pointer nodes
 {                                   //for dead actors after each tick
-    delete player;
-    for (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
-        delete *p;
+    for (int slot = 0; slot < m_store.size(); slot++)     //the store holds the player too
+        destroyActor(m_store.actor(slot));
+    
+    m_store.clear();
+    player = nullptr;
+    m_actorHash = 0;
     
-    allActors.erase(allActors.begin(), allActors.end());
+    m_cells.fill(vector<ActorHandle>());        //empty every bucket of the spatial index
+    
+    m_barriers.clear();
+    m_strikeable.clear();
+    m_stealables.clear();
+    m_kleptos.clear();
+    m_playerSpace.clear();
+    m_sightBlockers.clear();
+    m_sightLinesValid = false;
 }
 
 
 
 int StudentWorld::loadLevel()
 {
+    TRACE_ZONE("loadLevel");
     int lee = getLevel();
     
     if (lee == 100)     //can't play past level 100
@@ -112,90 +198,102 @@ int StudentWorld::loadLevel()
             {
                 case Level::wall:
                 {
-                    allActors.push_back(new Wall(this, x, y));
+                    addActor(new Wall(this, x, y));
                     break;
                 }
             
                 case Level::player:
                 {
                     player = new Player(this, x, y);
+                    m_playerSpace.set(x, y);
+                    m_sightLinesValid = false;
                     break;
                 }
                 
                 case Level::boulder:
                 {
-                    allActors.push_back(new Boulder(this, x, y));
+                    Boulder* bd = new Boulder(this, x, y);
+                    addActor(bd);
+                    m_boulderAt[y][x] = bd->getHandle();
                     break;
                 }
                 
                 case Level::jewel:
                 {
-                    allActors.push_back(new Jewel(this, x, y));
+                    addActor(new Jewel(this, x, y));
                     nJewel++;
                     break;
                 }
                     
                 case Level::exit:
                 {
-                    allActors.push_back(new Exit(this, x, y));
+                    Exit* ex = new Exit(this, x, y);
+                    addActor(ex);
+                    m_exits.push_back(ex->getHandle());
                     break;
                 }
                     
                 case Level::extra_life:
                 {
-                    allActors.push_back(new ExtraLife(this, x, y));
+                    addStealable(new ExtraLife(this, x, y));
                     break;
                 }
                 case Level::restore_health:
                 {
-                    allActors.push_back(new RestoreHealth(this, x, y));
+                    addStealable(new RestoreHealth(this, x, y));
                     break;
                 }
                     
                 case Level::ammo:
                 {
-                    allActors.push_back(new Ammo(this, x, y));
+                    addStealable(new Ammo(this, x, y));
                     break;
                 }
                  
                 case Level::hole:
                 {
-                    allActors.push_back(new Hole(this, x, y));
+                    Hole* hol = new Hole(this, x, y);
+                    addActor(hol);
+                    m_holeAt[y][x] = hol->getHandle();
                     break;
                 }
                 
                 case Level::horiz_snarlbot:
                 {
-                    allActors.push_back(new SnarlBot(this, x, y, GraphObject::right));
+                    addActor(new SnarlBot(this, x, y, GraphObject::right));
                     break;
                 }
                     
                 case Level::vert_snarlbot:
                 {
-                    allActors.push_back(new SnarlBot(this, x, y, GraphObject::down));
+                    addActor(new SnarlBot(this, x, y, GraphObject::down));
                     break;
                 }
                     
                 case Level::KleptoBot_factory:
                 {
-                    allActors.push_back(new Factory(this, x ,y, false));
+                    addActor(new Factory(this, x ,y, false));
                     break;
                 }
                     
                 case Level::angry_KleptoBot_factory:
                 {
-                    allActors.push_back(new Factory(this, x, y, true));
+                    addActor(new Factory(this, x, y, true));
                     break;
                 }
             }
         }
     }
 
+    m_store.partition(neverActs);   //keep walls, boulders and the player out of the per-tick pass
+    rehashAll();
+    
     return GWSTATUS_CONTINUE_GAME;
 }
 
 void StudentWorld::setTopDisplay()
 {
+    TRACE_ZONE("setTopDisplay");
     int score = getScore();     //update variables to current amounts
     int level = getLevel();
     int lives = getLives();
@@ -233,18 +331,20 @@ void StudentWorld::setTopDisplay()
 
 void StudentWorld::removeDead()
 {
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
+    TRACE_ZONE("removeDead");
+    for (int slot = 0; slot < m_store.size(); slot++)
     {
-        Jewel* jel = dynamic_cast<Jewel*>(*p);
-        if (jel != nullptr && !jel->isAlive())
-            nJewel--;   //if the Actor is a jewel, decrement nJewel--
-        
-        if (!(*p)->isAlive())
+        if (!m_store.alive(slot))
         {
-            delete *p;
-            allActors.erase(p);    //if the actor is dead delete and erase
+            Actor* dead = m_store.actor(slot);
+            removeFromCell(dead, dead->getX(), dead->getY());
+            removeFromRegistries(dead);
+            m_actorHash ^= m_store.hashTerm(slot);
+            destroyActor(dead);     //if the actor is dead delete it
         }
     }
+    
+    m_store.compact();  //then close up the gaps it left in one sweep
 }
 
 void StudentWorld::setLevelComplete()
@@ -259,15 +359,15 @@ void StudentWorld::addRunningBonus()
 
 void StudentWorld::openExit()
 {
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
+    for (size_t k = 0; k < m_exits.size(); k++)
     {
-        Exit* ex = dynamic_cast<Exit*>(*p);
-        if (ex != nullptr)      //find the exit
+        Exit* ex = static_cast<Exit*>(lookup(m_exits[k]));     //only Exits are registered here
+        if (ex != nullptr)
         {
             ex->setVisible(true);       //make it visible and set the variable to true
             ex->setOpen();
+            scheduleTurn(ex, 1);        //the player may already be standing on it
         }
-        
     }
     playSound(SOUND_REVEAL_EXIT);
     revealed = true;
@@ -277,6 +377,7 @@ void StudentWorld::openExit()
 
 bool StudentWorld::doCensusCount(int x, int y, int& count)
 {
+    PROFILE_SCOPE(m_profile, PROFILE_CENSUS);
     //the census is taken of a 7 x 7 area, the top, bottom, left, and right of the area must be set prior
     if (objectsOnSpace(x, y) > 1) //ensure the factory is by itself
         return false;
@@ -298,89 +399,168 @@ bool StudentWorld::doCensusCount(int x, int y, int& count)
         bottomCheck = 0;
     
     
-    for (int k = leftCheck; k <= rightCheck; k++)      //loop through area
+    if (!m_kleptoSumsValid)     //KleptoBots moved since the last census, rebuild the running sums
+        updateKleptoSums();
+    
+    //every KleptoBot in the area, from four corners of the running sums
+    count += m_kleptoSums[topCheck + 1][rightCheck + 1] - m_kleptoSums[bottomCheck][rightCheck + 1]
+           - m_kleptoSums[topCheck + 1][leftCheck] + m_kleptoSums[bottomCheck][leftCheck];
+    
+    return true;
+}
+
+void StudentWorld::updateKleptoSums()   //m_kleptoSums[y][x] is the number of KleptoBots on spaces
+{                                       //left of x and below y
+    PROFILE_SCOPE(m_profile, PROFILE_KLEPTO_SUMS);
+    for (int x = 0; x <= VIEW_WIDTH; x++)
+        m_kleptoSums[0][x] = 0;
+    
+    for (int y = 0; y < VIEW_HEIGHT; y++)
     {
-        for (int h = bottomCheck; h <= topCheck; h++)
+        int row = 0;
+        m_kleptoSums[y + 1][0] = 0;
+        for (int x = 0; x < VIEW_WIDTH; x++)
         {
-            
-            Actor* checkSpot = spaceContains(h, k);
-            if (checkSpot != nullptr && checkSpot->countsInFactoryCount()) //if it is a Kleptobot increment
-                count++;
+            row += m_kleptoCount[y][x];
+            m_kleptoSums[y + 1][x + 1] = m_kleptoSums[y][x + 1] + row;
         }
     }
     
-    return true;
+    m_kleptoSumsValid = true;
 }
 
 bool StudentWorld::containsBarrier(int x, int y)
 {
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
-    {
-        if ((*p)->getX() == x && (*p)->getY() == y &&(*p)->isBarrier()) //check that any object at given
-            return true;                                                //space serves as a barrier
-    }
-    
-    return false;
+    PROFILE_COUNT(m_profile, PROFILE_BARRIER);
+    return m_barriers.test(x, y);       //check that any object at given space serves as a barrier
 }
 
 bool StudentWorld::checkPlayer(int x, int y)        //check that the player is not on the given space
 {
-    if (player->getX() == x && player->getY() == y)
-        return false;
-    
-    return true;
+    return !m_playerSpace.test(x, y);
 }
 
 int StudentWorld::objectsOnSpace(int x, int y)  //counts the number of Actors on the given space
 {                                               //***Player not included in the count
-    int count = 0;
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
-    {
-        if ((*p)->getX() == x && (*p)->getY() == y)
-            count++;
-    }
+    PROFILE_COUNT(m_profile, PROFILE_OBJECTS_ON_SPACE);
+    return occupantsOf(x, y).size();
+}
+
+const vector<ActorHandle>& StudentWorld::occupantsOf(int x, int y) const
+{
+    static const vector<ActorHandle> outside;   //spaces off the board never hold anything
     
-    return count;
+    if (x < 0 || x >= VIEW_WIDTH || y < 0 || y >= VIEW_HEIGHT)
+        return outside;
+    
+    return m_cells.at(x, y);
 }
 
 
 
 void StudentWorld::addBullet(int x, int y, Accessible::Direction facing)
 {
-    allActors.push_back(new Bullet(this, x, y, facing));
+    addActor(m_bulletPool.create(this, x, y, facing));     //bullets are built in the pool, not on the heap
 }
 
 void StudentWorld::addKleptoBot(int x, int y, int bonus)
 {
     if (bonus == 10)    // bonus if 10 for a RegularKleptoBot
-        allActors.push_back(new RegularKleptoBot(this, x, y));
+        addActor(new RegularKleptoBot(this, x, y));
     
     else if (bonus == 20)   // bonus if 20 for an AngryKleptoBot
-        allActors.push_back(new AngryKleptoBot(this, x, y));
+        addActor(new AngryKleptoBot(this, x, y));
 }
 
 void StudentWorld::addGoodieBack(int x, int y, char goodieKind)
 {
     if (goodieKind == 'L')      //the char goodieKind determines the kind of goodie to add back to the game
-        allActors.push_back(new ExtraLife(this, x, y));
+        addStealable(new ExtraLife(this, x, y));
     
     if (goodieKind == 'R')
-        allActors.push_back(new RestoreHealth(this, x, y));
+        addStealable(new RestoreHealth(this, x, y));
     
     if (goodieKind == 'A')
-        allActors.push_back(new Ammo(this, x, y));
+        addStealable(new Ammo(this, x, y));
 }
 
 
 
-Actor* StudentWorld::spaceContains(int x, int y)        //valuable function throughout the program
+static const Bitboard& sightRay(int x, int y, GraphObject::Direction d)
 {
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
+    struct RayTable     //rays from every space in every direction, built once
     {
-        Actor* ptr = *p;
-        if ((*p)->getX() == x && (*p)->getY() == y)
-            return ptr; //return first object in the list on the give space
+        Bitboard rays[5][BOARD_SPACES];
+        
+        RayTable()
+        {
+            for (int y = 0; y < VIEW_HEIGHT; y++)
+            {
+                for (int x = 0; x < VIEW_WIDTH; x++)
+                {
+                    int i = Bitboard::index(x, y);
+                    rays[GraphObject::up][i] = Bitboard::ray(x, y, 0, 1);
+                    rays[GraphObject::down][i] = Bitboard::ray(x, y, 0, -1);
+                    rays[GraphObject::left][i] = Bitboard::ray(x, y, -1, 0);
+                    rays[GraphObject::right][i] = Bitboard::ray(x, y, 1, 0);
+                }
+            }
+        }
+    };
+    static const RayTable table;
+    return table.rays[d][Bitboard::index(x, y)];
+}
+
+bool StudentWorld::playerInSight(int x, int y, GraphObject::Direction facing)
+{
+    PROFILE_COUNT(m_profile, PROFILE_IN_SIGHT);
+    if (!m_sightLinesValid)
+        updateSightLines();
+    
+    return m_sightLines[facing].test(x, y);
+}
+
+void StudentWorld::updateSightLines()       //answers playerInSight for every space and direction at once
+{
+    PROFILE_SCOPE(m_profile, PROFILE_SIGHT_LINES);
+    //a robot facing d has a shot if it is on the ray leaving the player in the opposite direction and
+    //no space between them is blocked.  That is the ray up to and including the nearest blocked space
+    const GraphObject::Direction facing[4] = { GraphObject::up, GraphObject::down,
+                                               GraphObject::left, GraphObject::right };
+    const GraphObject::Direction behind[4] = { GraphObject::down, GraphObject::up,
+                                               GraphObject::right, GraphObject::left };
+    
+    int px = player->getX();
+    int py = player->getY();
+    
+    for (int k = 0; k < 4; k++)
+    {
+        const Bitboard& line = sightRay(px, py, behind[k]);
+        Bitboard blocked = line & m_sightBlockers;
+        
+        m_sightLines[facing[k]] = line;
+        if (blocked.any())
+        {
+            //down and left rays run toward lower bit indexes, so their nearest space is the highest
+            bool towardLower = (behind[k] == GraphObject::down || behind[k] == GraphObject::left);
+            int nearest = towardLower ? blocked.highest() : blocked.lowest();
+            m_sightLines[facing[k]] &= ~sightRay(nearest % VIEW_WIDTH, nearest / VIEW_WIDTH, behind[k]);
+        }
     }
+    m_sightLines[GraphObject::none].clear();
+    
+    m_sightLinesValid = true;
+}
+
+Actor* StudentWorld::spaceContains(int x, int y)        //valuable function throughout the program
+{
+    PROFILE_COUNT(m_profile, PROFILE_SPACE_CONTAINS);
+    const vector<ActorHandle>& here = occupantsOf(x, y);
+    if (!here.empty())
+    {
+        PROFILE_SCANNED(1);
+        return lookup(here.front());
+    }    //return first object in the list on the give space
     
     if (player->getX() == x && player->getY() == y)
         return player;
@@ -391,15 +571,37 @@ Actor* StudentWorld::spaceContains(int x, int y)        //valuable function thro
 
 Actor* StudentWorld::secondBulletCheck(int x, int y)    //used to ensure that no Actor on the space
 {                                                       //can be struck by a bullet
-        for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
-        {
-            if ((*p)->getX() == x && (*p)->getY() == y && (*p)->getBulletEffect() == BULLET_STRIKES)
-            return *p;
-        }
+    PROFILE_COUNT(m_profile, PROFILE_BULLET_CHECK);
+    if (!m_strikeable.test(x, y))
+        return nullptr;
+    
+    const vector<ActorHandle>& here = occupantsOf(x, y);
+    for (size_t k = 0; k < here.size(); k++)
+    {
+        PROFILE_SCANNED(1);
+        Actor* act = lookup(here[k]);
+        if (act->getBulletEffect() == BULLET_STRIKES)
+            return act;
+    }
     
     return nullptr;
 }
 
+TickProfile& StudentWorld::profile()
+{
+    return m_profile;
+}
+
+ActorStore& StudentWorld::getActorStore()
+{
+    return m_store;
+}
+
+Actor* StudentWorld::lookup(ActorHandle h) const
+{
+    return m_store.lookup(h);
+}
+
 Player* StudentWorld::getPlayer()
 {
     return player;
@@ -407,28 +609,626 @@ Player* StudentWorld::getPlayer()
 
 Boulder* StudentWorld::getBoulder(int x, int y)     //return a pointer to a boulder at the intended space
 {
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
+    if (!Bitboard::onBoard(x, y))
+        return nullptr;
+    
+    return static_cast<Boulder*>(lookup(m_boulderAt[y][x]));
+        
+}
+
+Pickup* StudentWorld::takeStealable(int x, int y)       //return a pointer to a Stealable item a given (x,y)
+{
+    PROFILE_COUNT(m_profile, PROFILE_TAKE_STEALABLE);
+    if (!m_stealables.test(x, y))
+        return nullptr;
+    
+    PROFILE_SCANNED(1);
+    
+    return static_cast<Pickup*>(lookup(m_stealableAt.at(x, y).front()));   //the first goodie on the
+                                                                            //space in list order
+}
+
+Hole* StudentWorld::getHole(int x, int y)       //return a pointer to a hole at the given space
+{
+    if (!Bitboard::onBoard(x, y))
+        return nullptr;
+    
+    return static_cast<Hole*>(lookup(m_holeAt[y][x]));
+}
+
+void StudentWorld::jewelCollected()
+{
+    nJewel--;
+}
+
+void StudentWorld::addKeyframe(bool withSnapshot)
+{
+    Replay::Keyframe kf;
+    kf.level = getLevel();
+    kf.score = getScore();
+    kf.lives = getLives();
+    m_random.getState(kf.random);
+    
+    Snapshot snap;
+    if (withSnapshot && saveSnapshot(snap))
+        kf.snapshot = snap.bytes();
+    recording()->addKeyframe(kf);
+}
+
+void StudentWorld::restoreKeyframe(const Replay::Keyframe& kf)
+{
+    GameWorld::restoreKeyframe(kf);
+    m_random.setState(kf.random);
+}
+
+int StudentWorld::randInt(int min, int max)
+{
+    return m_random.randInt(min, max);
+}
+
+
+
+void StudentWorld::updateLocation(Actor* act, int oldX, int oldY)
+{
+    rehash(act);
+    
+    if (act == player)      //the player is kept by itself and not in any bucket
     {
-        Boulder* bd = dynamic_cast<Boulder*>(*p);
-        if (bd != nullptr && bd->getX() ==  x && bd->getY() == y)
-            return bd;
+        m_playerSpace.reset(oldX, oldY);
+        m_playerSpace.set(act->getX(), act->getY());
+        m_sightLinesValid = false;
+        fireSpaceTriggers(act);
+        return;
     }
     
-    return nullptr;
+    if (act->getX() == oldX && act->getY() == oldY)
+        return;
+    
+    removeFromCell(act, oldX, oldY);
+    addToCell(act);
+    
+    if (lookup(m_boulderAt[oldY][oldX]) == act)    //boulders are the only registered Actors that move
+    {
+        m_boulderAt[act->getY()][act->getX()] = m_boulderAt[oldY][oldX];
+        m_boulderAt[oldY][oldX] = ActorHandle();
+    }
+    
+    fireSpaceTriggers(act);
+}
+
+void StudentWorld::addSpaceTrigger(Actor* watcher, int x, int y)
+{
+    m_triggers.edit(x, y).push_back(watcher->getHandle());
+}
+
+void StudentWorld::fireSpaceTriggers(Actor* entrant)
+{
+    int x = entrant->getX();
+    int y = entrant->getY();
+    const vector<ActorHandle>& watchers = m_triggers.at(x, y);
+    PROFILE_SCOPE(m_profile, PROFILE_SPACE_TRIGGERS);
+    PROFILE_SCANNED(watchers.size());
+    
+    bool forgotten = false;
+    for (size_t k = 0; k < watchers.size(); k++)
+    {
+        Actor* watcher = lookup(watchers[k]);
+        if (watcher == nullptr)         //the watcher has been removed
+        {
+            forgotten = true;
+            continue;
+        }
+        watcher->spaceEntered(entrant);
+    }
+    
+    if (forgotten)      //only then does the bucket change, so a shared row stays shared otherwise
+    {
+        vector<ActorHandle>& kept = m_triggers.edit(x, y);
+        kept.erase(remove_if(kept.begin(), kept.end(), [this](ActorHandle h)
+        {
+            return lookup(h) == nullptr;
+        }), kept.end());
+    }
+}
+
+void StudentWorld::addActor(Actor* act)     //every Actor other than the player enters the game here
+{
+    act->setSerial(m_nextSerial++);     //the Actor put itself in the store when it was constructed
+    addToCell(act);
+    
+    if (actsEveryTick(m_store.kind(act->getSlot())))
+        scheduleTurn(act, 1);
+    
+    rehash(act);
+}
+
+void StudentWorld::destroyActor(Actor* act)
+{
+    if (!m_bulletPool.destroy(act))     //pooled Bullets go back to the pool, everything else is deleted
+        delete act;
+}
+
+void StudentWorld::addStealable(Pickup* pck)    //goodies a KleptoBot can steal never move, so each
+{                                               //space's registry stays in list order by appending
+    addActor(pck);
+    m_stealableAt.edit(pck->getX(), pck->getY()).push_back(pck->getHandle());
+}
+
+void StudentWorld::removeFromRegistries(Actor* act)     //called once for each Actor as it is removed
+{                                                       //single handles go stale on their own, only
+    if (act->isStealable())                             //the goodie lists need to drop an entry
+    {
+        vector<ActorHandle>& here = m_stealableAt.edit(act->getX(), act->getY());
+        ActorHandle h = act->getHandle();
+        for (vector<ActorHandle>::iterator p = here.begin(); p != here.end(); p++)
+        {
+            if (*p == h)
+            {
+                here.erase(p);
+                break;
+            }
+        }
+    }
+}
+
+void StudentWorld::addToCell(Actor* act)    //buckets stay sorted by serial so the first Actor in a
+{                                           //bucket is the first one on that space in the list
+    vector<ActorHandle>& here = m_cells.edit(act->getX(), act->getY());
+    
+    vector<ActorHandle>::iterator p = here.end();
+    while (p != here.begin() && lookup(*(p - 1))->getSerial() > act->getSerial())
+        p--;
+    
+    here.insert(p, act->getHandle());
+    refreshLayers(act->getX(), act->getY());
+    
+    if (act->countsInFactoryCount())
+    {
+        m_kleptoCount[act->getY()][act->getX()]++;
+        m_kleptoSumsValid = false;
+    }
+}
+
+void StudentWorld::removeFromCell(Actor* act, int x, int y)
+{
+    vector<ActorHandle>& here = m_cells.edit(x, y);
+    ActorHandle h = act->getHandle();
+    for (vector<ActorHandle>::iterator p = here.begin(); p != here.end(); p++)
+    {
+        if (*p == h)
+        {
+            here.erase(p);
+            refreshLayers(x, y);
+            
+            if (act->countsInFactoryCount())
+            {
+                m_kleptoCount[y][x]--;
+                m_kleptoSumsValid = false;
+            }
+            return;
+        }
+    }
+}
+
+void StudentWorld::refreshLayers(int x, int y)     //recompute every occupancy layer's bit for a space
+{
+    bool barrier = false;
+    bool strikeable = false;
+    bool stealable = false;
+    bool klepto = false;
+    
+    const vector<ActorHandle>& here = m_cells.at(x, y);
+    for (size_t k = 0; k < here.size(); k++)
+    {
+        Actor* act = lookup(here[k]);
+        barrier = barrier || act->isBarrier();
+        strikeable = strikeable || act->getBulletEffect() == BULLET_STRIKES;
+        stealable = stealable || act->isStealable();
+        klepto = klepto || act->countsInFactoryCount();
+    }
+    
+    m_barriers.assign(x, y, barrier);
+    m_strikeable.assign(x, y, strikeable);
+    m_stealables.assign(x, y, stealable);
+    m_kleptos.assign(x, y, klepto);
+    
+    bool blocks = !here.empty() && lookup(here.front())->isBarrier();
+    if (blocks != m_sightBlockers.test(x, y))
+    {
+        m_sightBlockers.assign(x, y, blocks);
+        m_sightLinesValid = false;
+    }
+}
+
+
+
+void StudentWorld::startTick()
+{
+    TRACE_ZONE("startTick");
+    //wake every Actor whose turn is this tick.  Handles of removed Actors no longer resolve, and a
+    //rescheduled Actor's old entry no longer matches its tick, so both are dropped here
+    vector<ActorHandle> due;
+    m_wheel.collect(m_now, due);
+    
+    m_awake.clear();
+    for (size_t k = 0; k < due.size(); k++)
+    {
+        int slot = m_store.slotOf(due[k]);
+        if (slot >= 0 && m_store.tick(slot) == m_now)
+            m_awake.push_back(slot);
+    }
+    sort(m_awake.begin(), m_awake.end());
+    
+    m_passSlot = -1;        //everyone is still to be visited
+}
+
+void StudentWorld::scheduleTurn(Actor* act, int visits)
+{
+    //the pass reaches an Actor this tick only if its slot comes after the one acting now, as newly
+    //added Actors always do.  Otherwise its first visit is next tick
+    int slot = act->getSlot();
+    unsigned int firstVisit = (slot > m_passSlot) ? m_now : m_now + 1;
+    unsigned int turn = firstVisit + visits - 1;
+    
+    if (turn == m_now)
+    {
+        if (m_store.tick(slot) == m_now)    //already awake this tick
+            return;
         
+        //this tick's pass is under way, join it in list order.  Newly added Actors land at the end
+        m_store.setTick(slot, turn);
+        m_awake.insert(upper_bound(m_awake.begin(), m_awake.end(), slot), slot);
+    }
+    else
+    {
+        m_store.setTick(slot, turn);
+        m_wheel.schedule(act->getHandle(), turn);
+    }
 }
 
-Pickup* StudentWorld::takeStealable(int x, int y)       //return a pointer to a Stealable item a given (x,y)
+bool StudentWorld::isTurn(const Actor* act) const
+{
+    return m_store.tick(act->getSlot()) == m_now;
+}
+
+
+//The state hash is Zobrist hashing with the keys made on demand.  Each Actor's term is a mix of
+//everything the hash covers about it, and the world keeps all the terms XORed together.  Whenever
+//something about an Actor changes, its old term is XORed out and its new one in, so the hash never
+//needs a walk over the Actors.  The world's own counters and the generator are mixed in when the
+//hash is asked for, which costs the same no matter how many Actors there are.
+//
+//How long each Actor still has to wait for its turn is not covered, as it counts down every tick
+
+uint64_t StudentWorld::stateHash() const
+{
+    uint32_t random[4];
+    m_random.getState(random);
+    
+    const uint64_t counters[] = { getLevel(), getScore(), getLives(), m_bonus,
+                                  static_cast<uint32_t>(nJewel), revealed, levelComplete,
+                                  random[0] | uint64_t(random[1]) << 32,
+                                  random[2] | uint64_t(random[3]) << 32 };
+    
+    uint64_t hash = m_actorHash;
+    for (size_t k = 0; k < sizeof(counters) / sizeof(counters[0]); k++)
+        hash = Random::mix(hash ^ counters[k]);
+    return hash;
+}
+
+void StudentWorld::rehash(Actor* act)
+{
+    int slot = act->getSlot();
+    uint64_t term = actorTerm(slot);
+    m_actorHash ^= m_store.hashTerm(slot) ^ term;
+    m_store.setHashTerm(slot, term);
+}
+
+uint64_t StudentWorld::actorTerm(int slot) const
+{
+    const Actor* act = m_store.actor(slot);
+    uint64_t fields = uint64_t(m_store.kind(slot)) | uint64_t(m_store.x(slot) & 0xFF) << 8
+                    | uint64_t(m_store.y(slot) & 0xFF) << 16
+                    | uint64_t(static_cast<uint16_t>(m_store.hitPoints(slot))) << 24
+                    | uint64_t(act->getDirection()) << 40 | uint64_t(m_store.alive(slot)) << 44;
+    return Random::mix(fields ^ Random::mix(act->stateKey() + 0x9E3779B97F4A7C15ULL));
+}
+
+void StudentWorld::rehashAll()      //after a level or a snapshot is loaded, every term from scratch
+{
+    m_actorHash = 0;
+    for (int slot = 0; slot < m_store.size(); slot++)
+    {
+        uint64_t term = actorTerm(slot);
+        m_store.setHashTerm(slot, term);
+        m_actorHash ^= term;
+    }
+}
+
+
+
+bool StudentWorld::saveSnapshot(Snapshot& snap)
+{
+    if (m_passSlot != BEFORE_NEXT_TICK)     //only between ticks, when every dead Actor is gone
+        return false;
+    
+    snap.clear();
+    snap.put(SNAPSHOT_VERSION);
+    snap.put(getLevel());
+    snap.put(getScore());
+    snap.put(getLives());
+    snap.put(m_bonus);
+    snap.putInt(nJewel);
+    snap.put(revealed);
+    snap.put(levelComplete);
+    snap.put(m_now);
+    snap.put(m_nextSerial);
+    
+    uint32_t random[4];
+    m_random.getState(random);
+    for (int k = 0; k < 4; k++)
+        snap.put(random[k]);
+    
+    //every Actor in list order.  A turn that has already passed is stored as 0, since only turns
+    //still to come are ever compared against.  Serials are stored as the change from the last one
+    snap.put(m_store.size());
+    unsigned int lastSerial = 0;
+    for (int slot = 0; slot < m_store.size(); slot++)
+    {
+        Actor* act = m_store.actor(slot);
+        unsigned int tick = m_store.tick(slot);
+        
+        snap.put(m_store.kind(slot));
+        snap.put(m_store.x(slot));
+        snap.put(m_store.y(slot));
+        snap.put(act->getDirection());
+        snap.putInt(m_store.hitPoints(slot));
+        snap.put(tick > m_now ? tick - m_now : 0);
+        snap.putInt(static_cast<int>(act->getSerial() - lastSerial));
+        act->saveState(snap);
+        
+        lastSerial = act->getSerial();
+    }
+    return true;
+}
+
+bool StudentWorld::restoreSnapshot(Snapshot& snap)
+{
+    cleanUp();
+    resetState();
+    
+    if (!rebuildFromSnapshot(snap))
+    {
+        cleanUp();      //never leave half a world behind
+        return false;
+    }
+    return true;
+}
+
+bool StudentWorld::rebuildFromSnapshot(Snapshot& snap)
+{
+    //the level file is never read, every Actor is rebuilt as loadLevel() or the tick would have
+    //added it, then given back its saved state
+    snap.rewind();
+    
+    unsigned int version, level, score, lives;
+    uint32_t random[4];
+    unsigned int actors;
+    if (!snap.getUnsigned(version) || version != SNAPSHOT_VERSION || !snap.getUnsigned(level) ||
+        !snap.getUnsigned(score) || !snap.getUnsigned(lives))
+        return false;
+    
+    if (!snap.getUnsigned(m_bonus) || !snap.getInt(nJewel) || !snap.getUnsigned(revealed) ||
+        !snap.getUnsigned(levelComplete) || !snap.getUnsigned(m_now) ||
+        !snap.getUnsigned(m_nextSerial))
+        return false;
+    unsigned int nextSerial = m_nextSerial;
+    
+    for (int k = 0; k < 4; k++)
+        if (!snap.getUnsigned(random[k]))
+            return false;
+    
+    if (!snap.getUnsigned(actors))
+        return false;
+    
+    unsigned int serial = 0;
+    for (unsigned int k = 0; k < actors; k++)
+    {
+        int kind, x, y, direction, hitPoints, serialChange;
+        unsigned int turnsAway;
+        if (!snap.getUnsigned(kind) || !snap.getUnsigned(x) || !snap.getUnsigned(y) ||
+            !snap.getUnsigned(direction) || !snap.getInt(hitPoints) || !snap.getUnsigned(turnsAway) ||
+            !snap.getInt(serialChange))
+            return false;
+        
+        if (!Bitboard::onBoard(x, y) || direction > GraphObject::right)
+            return false;
+        
+        serial += serialChange;
+        m_nextSerial = serial;      //addActor() hands the Actor this serial
+        
+        Actor* act = rebuildActor(kind, x, y, static_cast<GraphObject::Direction>(direction));
+        if (act == nullptr)
+            return false;
+        
+        act->setDirection(static_cast<GraphObject::Direction>(direction));
+        act->setHealth(hitPoints);
+        m_store.setTick(act->getSlot(), turnsAway > 0 ? m_now + turnsAway : 0);
+        if (!act->restoreState(snap))
+            return false;
+    }
+    m_nextSerial = nextSerial;
+    
+    //the Actors were rebuilt in list order, so this only finds where the static ones end.  Then
+    //forget the turns the constructors scheduled and file the saved ones
+    m_store.partition(neverActs);
+    m_wheel.clear();
+    for (int slot = 0; slot < m_store.size(); slot++)
+        if (m_store.tick(slot) > m_now)
+            m_wheel.schedule(m_store.handleOf(slot), m_store.tick(slot));
+    
+    m_passSlot = BEFORE_NEXT_TICK;
+    m_sightLinesValid = false;
+    m_kleptoSumsValid = false;
+    rehashAll();
+    
+    //KleptoBots draw from the generator as they're built, so it's put back last
+    Replay::Keyframe kf;
+    kf.level = level;
+    kf.score = score;
+    kf.lives = lives;
+    for (int k = 0; k < 4; k++)
+        kf.random[k] = random[k];
+    restoreKeyframe(kf);
+    
+    return player != nullptr;
+}
+
+Actor* StudentWorld::rebuildActor(int kind, int x, int y, GraphObject::Direction dir)
+{
+    Actor* act = nullptr;
+    switch (kind)       //register each kind just as loadLevel() and the add functions do
+    {
+        case IID_PLAYER:
+        {
+            if (player != nullptr)
+                return nullptr;
+            player = new Player(this, x, y);
+            m_playerSpace.set(x, y);
+            return player;
+        }
+            
+        case IID_WALL:              act = new Wall(this, x, y);                 break;
+        case IID_JEWEL:             act = new Jewel(this, x, y);                break;
+        case IID_SNARLBOT:          act = new SnarlBot(this, x, y, dir);        break;
+        case IID_KleptoBot:         act = new RegularKleptoBot(this, x, y);     break;
+        case IID_ANGRY_KleptoBot:   act = new AngryKleptoBot(this, x, y);       break;
+        case IID_ROBOT_FACTORY:     act = new Factory(this, x, y, false);       break;  //restoreState()
+        case IID_BULLET:            act = m_bulletPool.create(this, x, y, dir); break;  //sets m_angry
+            
+        case IID_BOULDER:
+        {
+            Boulder* bd = new Boulder(this, x, y);
+            addActor(bd);
+            m_boulderAt[y][x] = bd->getHandle();
+            return bd;
+        }
+            
+        case IID_HOLE:
+        {
+            Hole* hol = new Hole(this, x, y);
+            addActor(hol);
+            m_holeAt[y][x] = hol->getHandle();
+            return hol;
+        }
+            
+        case IID_EXIT:
+        {
+            Exit* ex = new Exit(this, x, y);
+            addActor(ex);
+            m_exits.push_back(ex->getHandle());
+            return ex;
+        }
+            
+        case IID_EXTRA_LIFE:
+        case IID_RESTORE_HEALTH:
+        case IID_AMMO:
+        {
+            Pickup* pck;
+            if (kind == IID_EXTRA_LIFE)
+                pck = new ExtraLife(this, x, y);
+            else if (kind == IID_RESTORE_HEALTH)
+                pck = new RestoreHealth(this, x, y);
+            else
+                pck = new Ammo(this, x, y);
+            addStealable(pck);
+            return pck;
+        }
+            
+        default:
+            return nullptr;
+    }
+    
+    addActor(act);
+    return act;
+}
+
+
+
+GameWorld* StudentWorld::fork()
+{
+    if (m_passSlot != BEFORE_NEXT_TICK || player == nullptr)   //only between ticks of a loaded level
+        return nullptr;
+    
+    return new StudentWorld(*this);
+}
+
+StudentWorld::StudentWorld(const StudentWorld& other)
+ : GameWorld(other), m_random(other.m_random), m_store(other.m_store), m_wheel(other.m_wheel),
+   m_now(other.m_now), m_passSlot(other.m_passSlot), m_cells(other.m_cells),
+   m_nextSerial(other.m_nextSerial), m_actorHash(other.m_actorHash), m_barriers(other.m_barriers), m_strikeable(other.m_strikeable),
+   m_stealables(other.m_stealables), m_kleptos(other.m_kleptos), m_playerSpace(other.m_playerSpace),
+   m_sightBlockers(other.m_sightBlockers), m_stealableAt(other.m_stealableAt),
+   m_exits(other.m_exits), m_triggers(other.m_triggers), m_kleptoSumsValid(other.m_kleptoSumsValid),
+   m_sightLinesValid(other.m_sightLinesValid), player(nullptr), m_bonus(other.m_bonus),
+   nJewel(other.nJewel), revealed(other.revealed), levelComplete(other.levelComplete)
 {
-    for  (list<Actor*>::iterator p = allActors.begin(); p != allActors.end(); p++)
+    startRecording(nullptr);    //the game being recorded is the one that was forked
+    
+    for (int y = 0; y < VIEW_HEIGHT; y++)
     {
-        if ((*p)->getX() == x && (*p)->getY() == y && (*p)->isStealable())
+        for (int x = 0; x < VIEW_WIDTH; x++)
         {
-            Pickup* pck = dynamic_cast<Pickup*>(*p);
-            if (pck != nullptr)
-               return pck;
+            m_boulderAt[y][x] = other.m_boulderAt[y][x];
+            m_holeAt[y][x] = other.m_holeAt[y][x];
+            m_kleptoCount[y][x] = other.m_kleptoCount[y][x];
         }
     }
+    for (int y = 0; y <= VIEW_HEIGHT; y++)
+        for (int x = 0; x <= VIEW_WIDTH; x++)
+            m_kleptoSums[y][x] = other.m_kleptoSums[y][x];
+    for (int d = 0; d < 5; d++)
+        m_sightLines[d] = other.m_sightLines[d];
     
-    return nullptr;
+    //the store, wheel and grids came over with the same handles, so only the Actors themselves need
+    //copying.  Each copy keeps its slot and is pointed at this world
+    for (int slot = 0; slot < m_store.size(); slot++)
+    {
+        Actor* copy = other.m_store.actor(slot)->clone();
+        copy->setWorld(this);
+        m_store.setActor(slot, copy);
+    }
+    player = static_cast<Player*>(m_store.actor(other.player->getSlot()));
+}
+
+static size_t actorBytes(int kind)
+{
+    switch (kind)
+    {
+        case IID_PLAYER:            return sizeof(Player);
+        case IID_SNARLBOT:          return sizeof(SnarlBot);
+        case IID_KleptoBot:         return sizeof(RegularKleptoBot);
+        case IID_ANGRY_KleptoBot:   return sizeof(AngryKleptoBot);
+        case IID_ROBOT_FACTORY:     return sizeof(Factory);
+        case IID_WALL:              return sizeof(Wall);
+        case IID_BOULDER:           return sizeof(Boulder);
+        case IID_HOLE:              return sizeof(Hole);
+        case IID_JEWEL:             return sizeof(Jewel);
+        case IID_EXIT:              return sizeof(Exit);
+        case IID_EXTRA_LIFE:        return sizeof(ExtraLife);
+        case IID_RESTORE_HEALTH:    return sizeof(RestoreHealth);
+        case IID_AMMO:              return sizeof(Ammo);
+        case IID_BULLET:            return sizeof(Bullet);
+    }
+    return 0;
+}
+
+size_t StudentWorld::unsharedBytes() const     //the world, its store, its Actors and the grid rows
+                                                //only it holds
+{
+    size_t bytes = sizeof(*this) + m_store.bytes() + m_bulletPool.bytes();
+    bytes += m_cells.unsharedBytes() + m_stealableAt.unsharedBytes() + m_triggers.unsharedBytes();
+    for (int slot = 0; slot < m_store.size(); slot++)
+        bytes += actorBytes(m_store.kind(slot));
+    return bytes;
 }
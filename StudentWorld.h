@@ -4,24 +4,38 @@
 #include "GameWorld.h"
 #include "GameConstants.h"
 #include "Actor.h"
+#include "ActorStore.h"
 #include "Level.h"
+#include "Bitboard.h"
+#include "TimingWheel.h"
+#include "BulletPool.h"
+#include "Random.h"
+#include "CowGrid.h"
+#include "TickProfile.h"
 #include <iostream>
-#include <list>
 #include <string>
+#include <vector>
 
 class Player;
 
 class StudentWorld : public GameWorld
 {
 public:
-	StudentWorld(std::string assetDir)
-	 : GameWorld(assetDir)
+	StudentWorld(std::string assetDir, unsigned int seed = 0)
+	 : GameWorld(assetDir), m_random(seed), player(nullptr)
 	{}
     ~StudentWorld();
     
     virtual int init();
     virtual int move();
     virtual void cleanUp();
+    virtual void restoreKeyframe(const Replay::Keyframe& kf);
+    virtual bool saveSnapshot(Snapshot& snap);      //false unless called between ticks
+    virtual bool restoreSnapshot(Snapshot& snap);   //in place of init().  If snap is damaged it
+                                                    //returns false and leaves the world empty
+    virtual GameWorld* fork();                      //nullptr unless called between ticks
+    virtual size_t unsharedBytes() const;
+    virtual uint64_t stateHash() const;
     
     
     //Game Functioning
@@ -31,6 +45,8 @@ public:
     void setLevelComplete();
     void addRunningBonus();
     void openExit();
+    void jewelCollected();
+    int randInt(int min, int max);      //every random choice in the game comes from here
     
     
     //Checks (Related to Actors Functioning Properly)
@@ -38,6 +54,9 @@ public:
     bool containsBarrier(int x, int y);
     bool checkPlayer(int x, int y);
     int objectsOnSpace(int x, int y);
+    bool playerInSight(int x, int y, GraphObject::Direction facing);
+    const vector<ActorHandle>& occupantsOf(int x, int y) const;  //every Actor on the space, in list
+                                                                 //order.  ***Player not included
     
     
     //Add Actor
@@ -45,17 +64,87 @@ public:
     void addKleptoBot(int x, int y, int bonus);
     void addGoodieBack(int x, int y, char goodieKind);
     
+    //Scheduling
+    void scheduleTurn(Actor* act, int visits);      //the Actor next acts on its visits-th tick from now
+    bool isTurn(const Actor* act) const;
+    
+    //State Hash
+    void rehash(Actor* act);        //called whenever anything the hash covers changes about an Actor
+    
+    //Spatial Index
+    void updateLocation(Actor* act, int oldX, int oldY);   //called by Actor::moveTo
+    void addSpaceTrigger(Actor* watcher, int x, int y);    //watcher->spaceEntered() is called whenever
+                                                           //anything, the player included, moves there
+    
+    //Profiling
+    TickProfile& profile();         //what the ticks so far have cost, all zero unless TICK_PROFILE
+    
     //Pointers
+    ActorStore& getActorStore();
+    Actor* lookup(ActorHandle h) const;     //nullptr once the Actor has been removed
     Actor* spaceContains(int x, int y);
     Actor* secondBulletCheck(int x, int y);
     Player* getPlayer();
     Boulder* getBoulder(int x, int y);
     Pickup* takeStealable(int x, int y);
+    Hole* getHole(int x, int y);
            // needed to check for robots on the same space as a
                                                   // as a pickup
     
 private:
-    list<Actor*> allActors;
+    StudentWorld(const StudentWorld& other);        //only fork() copies a world
+    StudentWorld& operator=(const StudentWorld&);
+    
+    void resetState();
+    void addKeyframe(bool withSnapshot);
+    bool rebuildFromSnapshot(Snapshot& snap);
+    Actor* rebuildActor(int kind, int x, int y, GraphObject::Direction dir);
+    void addActor(Actor* act);
+    void destroyActor(Actor* act);
+    void addStealable(Pickup* pck);
+    void removeFromRegistries(Actor* act);
+    void addToCell(Actor* act);
+    void removeFromCell(Actor* act, int x, int y);
+    void refreshLayers(int x, int y);
+    void updateSightLines();
+    void updateKleptoSums();
+    void startTick();
+    void fireSpaceTriggers(Actor* entrant);
+    uint64_t actorTerm(int slot) const;
+    void rehashAll();
+    
+    Random m_random;        //seeded once per world, so a seed and the keys pressed decide the game
+    ActorStore m_store;     //every Actor, the player included, in the order they act
+    BulletPool m_bulletPool;
+    
+    TimingWheel m_wheel;        //who acts on which tick
+    vector<int> m_awake;        //slots acting this tick, in order
+    unsigned int m_now;         //the current tick, the first move() of a level is tick 1
+    int m_passSlot;             //the slot acting now, -1 before the pass and BEFORE_NEXT_TICK after it
+    CowGrid<vector<ActorHandle> > m_cells;     //one bucket per space, kept in list order
+    unsigned int m_nextSerial;
+    uint64_t m_actorHash;       //every Actor's ActorStore::hashTerm() XORed together
+    TickProfile m_profile;      //a fork starts a profile of its own
+    
+    Bitboard m_barriers;        //occupancy layers, each bit says whether any Actor on that space
+    Bitboard m_strikeable;      //is a barrier, can be struck by a bullet, can be stolen by a KleptoBot
+    Bitboard m_stealables;      //or is a KleptoBot.  They are rebuilt from a bucket whenever it changes
+    Bitboard m_kleptos;
+    Bitboard m_playerSpace;     //the one space the player is on
+    Bitboard m_sightBlockers;   //spaces whose first Actor is a barrier, these block a robot's aim
+    
+    ActorHandle m_boulderAt[VIEW_HEIGHT][VIEW_WIDTH];           //registries of the kinds of Actors the
+    ActorHandle m_holeAt[VIEW_HEIGHT][VIEW_WIDTH];              //tick needs to find, so no RTTI is
+    CowGrid<vector<ActorHandle> > m_stealableAt;                //needed.  Handles of removed Actors
+    vector<ActorHandle> m_exits;                                //no longer resolve
+    CowGrid<vector<ActorHandle> > m_triggers;                   //Actors watching each space
+    
+    int m_kleptoCount[VIEW_HEIGHT][VIEW_WIDTH];             //KleptoBots on each space
+    int m_kleptoSums[VIEW_HEIGHT + 1][VIEW_WIDTH + 1];      //2D running sums of m_kleptoCount
+    bool m_kleptoSumsValid;                                 //for the Factory census
+    
+    Bitboard m_sightLines[5];   //indexed by direction, spaces from which a robot facing that way
+    bool m_sightLinesValid;     //has a clear shot at the player
     Player* player;
     unsigned int m_bonus;
     int nJewel;
@@ -0,0 +1,202 @@
+#ifndef TICKPROFILE_H_
+#define TICKPROFILE_H_
+
+#include "GameConstants.h"
+#include <chrono>
+#include <iostream>
+
+// A TickProfile counts what each part of the tick costs: how many times it ran, how long it took
+// and how many bucket entries it scanned.  There is one counter for each kind of Actor's
+// doSomething(), indexed by image ID, and one for each of the StudentWorld queries Actors lean on.
+// An Actor's time includes the queries it makes, so the two kinds of counter overlap.  Queries
+// that are only a bit test or a lookup are counted but not timed, since reading the clock would
+// cost more than the query and pad the time of the Actor making it.
+//
+// Counting is compiled in only when TICK_PROFILE is defined, say with -DTICK_PROFILE, so any other
+// build has no counters or timers at all and every counter stays at zero.  Each world keeps its
+// own profile, so worlds on different threads never share one.
+
+enum ProfileCounterID
+{
+    PROFILE_CENSUS = IID_AMMO + 1,  //counters up to IID_AMMO are the Actors' doSomething()
+    PROFILE_IN_SIGHT,
+    PROFILE_SPACE_CONTAINS,
+    PROFILE_BARRIER,
+    PROFILE_OBJECTS_ON_SPACE,
+    PROFILE_BULLET_CHECK,
+    PROFILE_TAKE_STEALABLE,
+    PROFILE_SPACE_TRIGGERS,
+    PROFILE_SIGHT_LINES,            //rebuilding the cached views
+    PROFILE_KLEPTO_SUMS,
+    PROFILE_COUNTERS
+};
+
+class TickProfile
+{
+public:
+    struct Counter
+    {
+        unsigned long long calls;
+        unsigned long long nanoseconds;
+        unsigned long long scanned;     //bucket entries looked at
+        bool timed;                     //false if only calls and entries are counted
+    };
+
+    static const bool enabled =
+#ifdef TICK_PROFILE
+        true;
+#else
+        false;
+#endif
+
+    TickProfile()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        m_ticks = 0;
+        for (int k = 0; k < PROFILE_COUNTERS; k++)
+        {
+            m_counters[k].calls = m_counters[k].nanoseconds = m_counters[k].scanned = 0;
+            m_counters[k].timed = false;
+        }
+    }
+
+    void countTick()
+    {
+        m_ticks++;
+    }
+
+    void record(int id, unsigned long long nanoseconds, unsigned long long scanned)
+    {
+        Counter& c = m_counters[id];
+        c.calls++;
+        c.nanoseconds += nanoseconds;
+        c.scanned += scanned;
+        c.timed = true;
+    }
+
+    void count(int id, unsigned long long scanned)      //a call that wasn't timed
+    {
+        Counter& c = m_counters[id];
+        c.calls++;
+        c.scanned += scanned;
+    }
+
+    unsigned long long ticks() const
+    {
+        return m_ticks;
+    }
+
+    const Counter& counter(int id) const
+    {
+        return m_counters[id];
+    }
+
+    static const char* name(int id)
+    {
+        static const char* const NAMES[PROFILE_COUNTERS] =
+        {
+            "Player", "SnarlBot", "KleptoBot", "AngryKleptoBot", "KleptoBotFactory", "Bullet",
+            "Wall", "Exit", "Boulder", "Hole", "Jewel", "RestoreHealth", "ExtraLife", "Ammo",
+            "doCensusCount", "playerInSight", "spaceContains", "containsBarrier",
+            "objectsOnSpace", "secondBulletCheck", "takeStealable", "fireSpaceTriggers",
+            "updateSightLines", "updateKleptoSums"
+        };
+        return NAMES[id];
+    }
+
+    void print(std::ostream& out) const     //per tick averages of every counter that ever ran
+    {
+        double ticks = (m_ticks > 0 ? double(m_ticks) : 1);
+        for (int k = 0; k < PROFILE_COUNTERS; k++)
+        {
+            const Counter& c = m_counters[k];
+            if (c.calls == 0)
+                continue;
+            out << "  " << name(k) << ": " << c.calls / ticks << " calls, ";
+            if (c.timed)
+                out << c.nanoseconds / ticks << " ns, ";
+            out << c.scanned / ticks << " scanned per tick" << std::endl;
+        }
+    }
+
+private:
+    unsigned long long m_ticks;
+    Counter m_counters[PROFILE_COUNTERS];
+};
+
+#ifdef TICK_PROFILE
+
+class ProfileScope      //records into a counter from construction to the end of the enclosing block
+{
+public:
+    ProfileScope(TickProfile& profile, int id)
+     : m_profile(profile), m_id(id), m_scanned(0), m_start(std::chrono::steady_clock::now())
+    {}
+
+    ~ProfileScope()
+    {
+        std::chrono::steady_clock::duration spent = std::chrono::steady_clock::now() - m_start;
+        m_profile.record(m_id, std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count(),
+                         m_scanned);
+    }
+
+    void scanned(unsigned long long entries)
+    {
+        m_scanned += entries;
+    }
+
+private:
+    TickProfile& m_profile;
+    int m_id;
+    unsigned long long m_scanned;
+    std::chrono::steady_clock::time_point m_start;
+
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+};
+
+class ProfileCount      //like ProfileScope, but never reads the clock
+{
+public:
+    ProfileCount(TickProfile& profile, int id)
+     : m_profile(profile), m_id(id), m_scanned(0)
+    {}
+
+    ~ProfileCount()
+    {
+        m_profile.count(m_id, m_scanned);
+    }
+
+    void scanned(unsigned long long entries)
+    {
+        m_scanned += entries;
+    }
+
+private:
+    TickProfile& m_profile;
+    int m_id;
+    unsigned long long m_scanned;
+
+    ProfileCount(const ProfileCount&);
+    ProfileCount& operator=(const ProfileCount&);
+};
+
+#define PROFILE_SCOPE(profile, id)  ProfileScope profileScope_(profile, id)
+#define PROFILE_COUNT(profile, id)  ProfileCount profileScope_(profile, id)
+#define PROFILE_SCANNED(entries)    profileScope_.scanned(entries)
+#define PROFILE_TICK(profile)       (profile).countTick()
+
+#else
+
+#define PROFILE_SCOPE(profile, id)  ((void)0)
+#define PROFILE_COUNT(profile, id)  ((void)0)
+#define PROFILE_SCANNED(entries)    ((void)0)
+#define PROFILE_TICK(profile)       ((void)0)
+
+#endif // TICK_PROFILE
+
+#endif // TICKPROFILE_H_
@@ -0,0 +1,31 @@
+#include "TimingWheel.h"
+using namespace std;
+
+void TimingWheel::schedule(ActorHandle h, unsigned int tick)
+{
+    Entry e;
+    e.handle = h;
+    e.tick = tick;
+    m_buckets[tick % WHEEL_SIZE].push_back(e);
+}
+
+void TimingWheel::collect(unsigned int tick, vector<ActorHandle>& due)
+{
+    vector<Entry>& bucket = m_buckets[tick % WHEEL_SIZE];
+
+    size_t kept = 0;
+    for (size_t k = 0; k < bucket.size(); k++)
+    {
+        if (bucket[k].tick == tick)
+            due.push_back(bucket[k].handle);
+        else
+            bucket[kept++] = bucket[k];     //a later trip around the wheel
+    }
+    bucket.resize(kept);
+}
+
+void TimingWheel::clear()
+{
+    for (int k = 0; k < WHEEL_SIZE; k++)
+        m_buckets[k].clear();
+}
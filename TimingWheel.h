@@ -0,0 +1,31 @@
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include "ActorStore.h"
+#include <vector>
+
+// TimingWheel remembers which Actors act on which tick.  An Actor is filed in the bucket for its
+// tick modulo the wheel size, so scheduling it and collecting a tick's Actors both cost only as
+// much as the number of Actors involved, no matter how many others are asleep.  Turns further
+// away than one trip around the wheel simply stay in their bucket until their tick comes up.
+
+class TimingWheel
+{
+public:
+    void schedule(ActorHandle h, unsigned int tick);
+    void collect(unsigned int tick, std::vector<ActorHandle>& due);    //takes out everything due
+    void clear();
+
+private:
+    static const int WHEEL_SIZE = 16;   //a power of two comfortably past the longest robot wait
+
+    struct Entry
+    {
+        ActorHandle handle;
+        unsigned int tick;
+    };
+
+    std::vector<Entry> m_buckets[WHEEL_SIZE];
+};
+
+#endif // TIMINGWHEEL_H_
@@ -0,0 +1,187 @@
+#include "Trace.h"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace std;
+
+atomic<bool> TraceLog::s_active(false);
+
+struct TraceEvent
+{
+    const char* name;
+    long long begin;        //nanoseconds since the trace started
+    long long duration;
+};
+
+struct TraceChunk      //a run of one thread's events, waiting for the writer
+{
+    int threadID;
+    vector<TraceEvent> events;
+};
+
+struct TraceBuffer
+{
+    TraceBuffer();
+    ~TraceBuffer();
+
+    mutex lock;         //only ever contended by stop()
+    int threadID;
+    vector<TraceEvent> events;
+};
+
+//everything below is guarded by logLock.  Code holding it may go on to lock a TraceBuffer,
+//never the other way around
+static mutex logLock;
+static condition_variable wakeWriter;
+static deque<TraceChunk> pending;
+static set<TraceBuffer*> buffers;
+static int nextThread = 1;
+static FILE* out = nullptr;
+static bool firstEvent = true;
+static bool stopping = false;
+static thread writer;
+static chrono::steady_clock::time_point origin;
+
+TraceBuffer::TraceBuffer()
+{
+    lock_guard<mutex> guard(logLock);
+    threadID = nextThread++;
+    buffers.insert(this);
+}
+
+TraceBuffer::~TraceBuffer()
+{
+    lock_guard<mutex> guard(logLock);
+    buffers.erase(this);
+    if (out != nullptr && !stopping && !events.empty())
+    {
+        TraceChunk chunk;
+        chunk.threadID = threadID;
+        chunk.events.swap(events);
+        pending.push_back(std::move(chunk));
+        wakeWriter.notify_one();
+    }
+}
+
+static TraceBuffer& threadBuffer()
+{
+    static thread_local TraceBuffer buffer;
+    return buffer;
+}
+
+static void writeChunk(const TraceChunk& chunk)      //only the writer thread touches the file
+{
+    for (size_t k = 0; k < chunk.events.size(); k++)
+    {
+        const TraceEvent& e = chunk.events[k];
+        fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                firstEvent ? "" : ",", e.name, chunk.threadID, e.begin / 1000.0, e.duration / 1000.0);
+        firstEvent = false;
+    }
+}
+
+static void writeChunks()
+{
+    unique_lock<mutex> guard(logLock);
+    for (;;)
+    {
+        wakeWriter.wait(guard, []() { return !pending.empty() || stopping; });
+        if (pending.empty())
+            return;         //stopping, and everything handed over has been written
+
+        TraceChunk chunk = std::move(pending.front());
+        pending.pop_front();
+        guard.unlock();
+        writeChunk(chunk);
+        guard.lock();
+    }
+}
+
+bool TraceLog::start(const string& path)
+{
+    stop();
+
+    lock_guard<mutex> guard(logLock);
+    out = fopen(path.c_str(), "w");
+    if (out == nullptr)
+        return false;
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+    firstEvent = true;
+    stopping = false;
+
+    for (set<TraceBuffer*>::iterator it = buffers.begin(); it != buffers.end(); it++)
+    {
+        lock_guard<mutex> bufferGuard((*it)->lock);
+        (*it)->events.clear();      //zones that ended after an earlier trace stopped
+    }
+
+    origin = chrono::steady_clock::now();
+    writer = thread(writeChunks);
+    s_active = true;
+    return true;
+}
+
+void TraceLog::stop()
+{
+    {
+        lock_guard<mutex> guard(logLock);
+        if (out == nullptr)
+            return;
+        s_active = false;
+
+        for (set<TraceBuffer*>::iterator it = buffers.begin(); it != buffers.end(); it++)
+        {
+            TraceChunk chunk;
+            chunk.threadID = (*it)->threadID;
+            {
+                lock_guard<mutex> bufferGuard((*it)->lock);
+                chunk.events.swap((*it)->events);
+            }
+            if (!chunk.events.empty())
+                pending.push_back(std::move(chunk));
+        }
+        stopping = true;
+    }
+    wakeWriter.notify_one();
+    writer.join();
+
+    lock_guard<mutex> guard(logLock);
+    fputs("\n]}\n", out);
+    fclose(out);
+    out = nullptr;
+}
+
+void TraceLog::record(const char* name, chrono::steady_clock::time_point begin,
+                      chrono::steady_clock::time_point end)
+{
+    if (!s_active.load(memory_order_acquire))     //start() sets origin first
+        return;
+
+    TraceBuffer& buffer = threadBuffer();
+    TraceEvent e;
+    e.name = name;
+    e.begin = chrono::duration_cast<chrono::nanoseconds>(begin - origin).count();
+    e.duration = chrono::duration_cast<chrono::nanoseconds>(end - begin).count();
+
+    TraceChunk full;
+    {
+        lock_guard<mutex> guard(buffer.lock);
+        buffer.events.push_back(e);
+        if (buffer.events.size() < CHUNK_EVENTS)
+            return;
+        full.threadID = buffer.threadID;
+        full.events.swap(buffer.events);
+        buffer.events.reserve(CHUNK_EVENTS);
+    }
+
+    lock_guard<mutex> guard(logLock);
+    if (stopping || out == nullptr)
+        return;
+    pending.push_back(std::move(full));
+    wakeWriter.notify_one();
+}
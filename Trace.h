@@ -0,0 +1,73 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// A TraceLog writes timed zones out as Chrome trace-event JSON, which chrome://tracing, Perfetto
+// and speedscope all open as a timeline.  Put TRACE_ZONE("name") at the top of a block and the
+// block shows up as one bar, nested under the zones around it, on its thread's row.  A zone
+// declared as a named TraceZone can be ended early with end(), to time part of a block.
+//
+// While no trace is running a zone costs one relaxed load.  While one is, each thread appends
+// finished zones to a buffer of its own, and every CHUNK_EVENTS zones hands the full buffer to a
+// writer thread, so the thread being traced never touches the file.  stop() hands over whatever
+// the buffers still hold, waits for the writer and closes the file.  A thread that exits hands
+// its buffer over as it goes.
+//
+// Zone names must be string literals, or otherwise outlive the trace.
+
+class TraceLog
+{
+public:
+    static const size_t CHUNK_EVENTS = 4096;
+
+    static bool start(const std::string& path);     //false if path can't be written
+    static void stop();
+
+    static bool active()
+    {
+        return s_active.load(std::memory_order_relaxed);
+    }
+
+    static void record(const char* name, std::chrono::steady_clock::time_point begin,
+                       std::chrono::steady_clock::time_point end);
+
+private:
+    static std::atomic<bool> s_active;
+};
+
+class TraceZone
+{
+public:
+    explicit TraceZone(const char* name)
+     : m_name(TraceLog::active() ? name : nullptr)
+    {
+        if (m_name != nullptr)
+            m_begin = std::chrono::steady_clock::now();
+    }
+
+    ~TraceZone()
+    {
+        end();
+    }
+
+    void end()      //ends the zone here rather than at the end of the block
+    {
+        if (m_name != nullptr)
+            TraceLog::record(m_name, m_begin, std::chrono::steady_clock::now());
+        m_name = nullptr;
+    }
+
+private:
+    const char* m_name;     //nullptr if no trace was running when the zone began
+    std::chrono::steady_clock::time_point m_begin;
+
+    TraceZone(const TraceZone&);
+    TraceZone& operator=(const TraceZone&);
+};
+
+#define TRACE_ZONE(name)    TraceZone traceZone_(name)
+
+#endif // TRACE_H_
@@ -0,0 +1,25 @@
+#ifndef WORLDCONTROLLER_H_
+#define WORLDCONTROLLER_H_
+
+#include <string>
+
+  // What a GameWorld needs from whatever is running it: the keys the player
+  // hits, somewhere to play sounds, somewhere to show the status line, and
+  // someone to tell when the player asks to quit.
+  // GameController provides these with a window; HeadlessController provides
+  // them without one.
+
+class WorldController
+{
+  public:
+	virtual ~WorldController()
+	{
+	}
+
+	virtual bool getLastKey(int& value) = 0;
+	virtual void playSound(int soundID) = 0;
+	virtual void setGameStatText(std::string text) = 0;
+	virtual void quitRequested() = 0;	// the player hit q or CTRL-C
+};
+
+#endif // WORLDCONTROLLER_H_
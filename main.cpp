@@ -1,10 +1,23 @@
 #include "glut.h"
 #include "GameController.h"
+#include "HeadlessController.h"
+#include "WorldController.h"
+#include "BatchRunner.h"
+#include "GameWorld.h"
+#include "LevelSolver.h"
+#include "SimBench.h"
+#include "Replay.h"
+#include "Snapshot.h"
+#include "Trace.h"
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <cstdlib>
 #include <ctime>
+#include <sstream>
+#include <thread>
 using namespace std;
 
   // If your program is having trouble finding the Assets directory,
@@ -15,10 +28,406 @@ const string assetDirectory = "/Users/Michaelgermano/Downloads/BoulderBlast/Deri
 
 class GameWorld;
 
-GameWorld* createStudentWorld(string assetDir = "");
+GameWorld* createStudentWorld(string assetDir = "", unsigned int seed = 0);
+
+static void printReport(const HeadlessController::Report& report)
+{
+	cout << report.ticks << " ticks in " << report.seconds << " s, "
+		 << report.ticksPerSecond() << " ticks/s" << endl;
+	cout << "levels finished: " << report.levelsFinished
+		 << ", lives lost: " << report.livesLost << endl;
+	cout << "final score: " << report.score << ", lives: " << report.lives
+		 << ", level: " << report.level << endl;
+	cout << "state hash: " << hex << report.stateHash << dec << endl;
+}
+
+  // BoulderBlast --headless [ticks [keys [seed [replayfile]]]] plays without a
+  // window, as fast as possible, and reports how many ticks per second the
+  // game ran at.  keys is a HeadlessController key script, one character per
+  // tick.  The same keys and seed always play the same game.  If a replay file
+  // is named, the game is recorded into it.
+
+static int runHeadless(int argc, char* argv[])
+{
+	long long ticks = (argc > 2 ? atoll(argv[2]) : 100000);
+	string keys = (argc > 3 ? argv[3] : "ddd aaa www sss ....");
+	unsigned int seed = (argc > 4 ? strtoul(argv[4], nullptr, 10) : 0);
+
+	GameWorld* gw = createStudentWorld(assetDirectory, seed);
+	Replay recording(seed, 0);
+	if (argc > 5)
+		gw->startRecording(&recording);
+
+	HeadlessController controller(keys);
+	HeadlessController::Report report = controller.run(gw, ticks);
+	delete gw;
+
+	printReport(report);
+	if (argc > 5 && !recording.save(argv[5]))
+	{
+		cout << "Cannot write " << argv[5] << endl;
+		return 1;
+	}
+	return 0;
+}
+
+  // BoulderBlast --replay replayfile [tick] plays a recorded game back without
+  // a window, as fast as possible, and reports where it ended up.  Given a
+  // tick, it starts from the nearest keyframe and stops at that tick.
+
+static int runReplay(int argc, char* argv[])
+{
+	Replay replay;
+	if (argc < 3 || !replay.load(argv[2]))
+	{
+		cout << "Cannot read replay " << (argc < 3 ? "" : argv[2]) << endl;
+		return 1;
+	}
+
+	GameWorld* gw = createStudentWorld(assetDirectory, replay.seed());
+	HeadlessController controller(&replay);
+	HeadlessController::Report report;
+	if (argc > 3)
+	{
+		long long tick = atoll(argv[3]);
+		report = controller.playTo(gw, tick < replay.ticks() ? tick : replay.ticks());
+		cout << "from keyframe at tick " << replay.position() - report.ticks << endl;
+	}
+	else
+		report = controller.run(gw, replay.ticks());
+	delete gw;
+
+	printReport(report);
+	return 0;
+}
+
+  // BoulderBlast --record replayfile plays in the window as usual and records
+  // the game into the file when the program exits.
+
+static Replay* recording = nullptr;
+static string recordingPath;
+
+static void saveRecording()
+{
+	if (recording != nullptr && !recording->save(recordingPath))
+		cout << "Cannot write " << recordingPath << endl;
+}
+
+  // BoulderBlast --batch worlds [ticks [keys [seed]]] plays that many headless
+  // games at once, first on one thread, then on twice as many each round up to
+  // the number of cores, and reports the combined throughput of each round.
+  // Game k is seeded with seed + k, so every round plays the same games.
+
+static int runBatch(int argc, char* argv[])
+{
+	int worlds = (argc > 2 ? atoi(argv[2]) : 1000);
+	long long ticks = (argc > 3 ? atoll(argv[3]) : 10000);
+	string keys = (argc > 4 ? argv[4] : "ddd aaa www sss ....");
+	unsigned int seed = (argc > 5 ? strtoul(argv[5], nullptr, 10) : 0);
+
+	int cores = static_cast<int>(thread::hardware_concurrency());
+	if (cores < 1)
+		cores = 1;
+
+	BatchRunner runner(assetDirectory, keys, ticks, seed);
+	double oneThread = 0;
+	for (int threads = 1; ; threads *= 2)
+	{
+		if (threads > cores)
+			threads = cores;
+
+		BatchRunner::Summary summary = runner.run(worlds, threads);
+		if (threads == 1)
+			oneThread = summary.ticksPerSecond();
+
+		cout << threads << " threads: " << summary.worlds << " worlds, "
+			 << summary.ticks << " ticks in " << summary.seconds << " s, "
+			 << summary.ticksPerSecond() << " ticks/s";
+		if (oneThread > 0)
+			cout << " (" << summary.ticksPerSecond() / oneThread << "x)";
+		cout << endl;
+
+		if (threads == cores)
+			break;
+	}
+	return 0;
+}
+
+  // BoulderBlast --snapshot-bench [ticks [count]] plays a headless game for
+  // that many ticks, then saves and restores the world count times each and
+  // reports how many snapshots per second it manages and how big they are.
+
+  // plays a world's first ticks with the player standing still, so the
+  // benchmarks below work on a game in progress
+static void playFor(GameWorld* gw, long long ticks)
+{
+	gw->init();
+	for (long long t = 0; t < ticks; t++)
+	{
+		int status = gw->move();
+		if (status != GWSTATUS_CONTINUE_GAME)
+		{
+			if (status == GWSTATUS_FINISHED_LEVEL)
+				gw->advanceToNextLevel();
+			gw->cleanUp();
+			gw->init();		// a freshly loaded level is still a world to use
+			if (gw->isGameOver())
+				break;
+		}
+	}
+}
+
+static int runSnapshotBench(int argc, char* argv[])
+{
+	long long ticks = (argc > 2 ? atoll(argv[2]) : 2000);
+	int count = (argc > 3 ? atoi(argv[3]) : 10000);
+
+	GameWorld* gw = createStudentWorld(assetDirectory, 0);
+	HeadlessController controller(string("."));	// only answers getKey, the player stays put
+	gw->setController(&controller);
+	playFor(gw, ticks);
+
+	Snapshot snap;
+	bool saved = true;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int k = 0; k < count && saved; k++)
+		saved = gw->saveSnapshot(snap);
+	chrono::duration<double> saving = chrono::steady_clock::now() - start;
+
+	start = chrono::steady_clock::now();
+	bool restored = saved;
+	for (int k = 0; k < count && restored; k++)
+	{
+		snap.rewind();
+		restored = gw->restoreSnapshot(snap);
+	}
+	chrono::duration<double> restoring = chrono::steady_clock::now() - start;
+	gw->cleanUp();
+	delete gw;
+
+	if (!restored)
+	{
+		cout << "Cannot restore the snapshot" << endl;
+		return 1;
+	}
+	cout << "snapshot: " << snap.bytes().size() << " bytes" << endl;
+	cout << "saves: " << count / saving.count() << "/s, restores: "
+		 << count / restoring.count() << "/s" << endl;
+	return 0;
+}
+
+  // a controller that holds down one key, or none, for a forked world
+
+class HeldKey : public WorldController
+{
+public:
+	HeldKey(int key)
+	 : m_key(key)
+	{}
+
+	virtual bool getLastKey(int& value)
+	{
+		value = m_key;
+		return m_key != 0;
+	}
+
+	virtual void playSound(int) {}
+	virtual void setGameStatText(string) {}
+	virtual void quitRequested() {}
+
+private:
+	int m_key;
+};
+
+  // BoulderBlast --fork-bench [ticks [rounds [ahead]]] plays a headless game
+  // for that many ticks, then forks the world once for every key the player
+  // could press and plays each fork ahead that many ticks holding its key,
+  // the way a search would.  It reports forks per second with and without
+  // the look-ahead, and the memory a fork holds of its own.
+
+static int runForkBench(int argc, char* argv[])
+{
+	long long ticks = (argc > 2 ? atoll(argv[2]) : 2000);
+	int rounds = (argc > 3 ? atoi(argv[3]) : 2000);
+	int ahead = (argc > 4 ? atoi(argv[4]) : 30);
+
+	GameWorld* gw = createStudentWorld(assetDirectory, 0);
+	HeadlessController controller(string("."));
+	gw->setController(&controller);
+	playFor(gw, ticks);
+
+	GameWorld* probe = gw->fork();
+	if (probe == nullptr)
+	{
+		cout << "Cannot fork the world" << endl;
+		delete gw;
+		return 1;
+	}
+	size_t freshBytes = probe->unsharedBytes();
+	delete probe;
+
+	const int KEYS = 6;
+	HeldKey keys[KEYS] = { HeldKey(0), HeldKey(KEY_PRESS_LEFT), HeldKey(KEY_PRESS_RIGHT),
+						   HeldKey(KEY_PRESS_UP), HeldKey(KEY_PRESS_DOWN), HeldKey(KEY_PRESS_SPACE) };
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++)
+		for (int k = 0; k < KEYS; k++)
+			delete gw->fork();
+	chrono::duration<double> forking = chrono::steady_clock::now() - start;
+
+	size_t branchBytes = 0;
+	start = chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++)
+	{
+		for (int k = 0; k < KEYS; k++)
+		{
+			GameWorld* branch = gw->fork();
+			branch->setController(&keys[k]);
+			for (int t = 0; t < ahead && branch->move() == GWSTATUS_CONTINUE_GAME; t++)
+				;
+			branchBytes += branch->unsharedBytes();
+			delete branch;
+		}
+	}
+	chrono::duration<double> searching = chrono::steady_clock::now() - start;
+	delete gw;
+
+	int forks = rounds * KEYS;
+	cout << "forks: " << forks / forking.count() << "/s, " << freshBytes
+		 << " bytes of their own" << endl;
+	cout << "forks played " << ahead << " ticks ahead: " << forks / searching.count()
+		 << "/s, " << branchBytes / forks << " bytes of their own" << endl;
+	return 0;
+}
+
+  // BoulderBlast --solve [threads [maxStates]] checks every level in the
+  // asset directory, level00.dat onward until one is missing, with a
+  // LevelSolver on that many threads, all the cores by default.  It prints
+  // whether each level can be finished, and a shortest way to finish it as a
+  // key script for --headless.
+
+static int runSolve(int argc, char* argv[])
+{
+	int threads = (argc > 2 ? atoi(argv[2]) : static_cast<int>(thread::hardware_concurrency()));
+	long long maxStates = (argc > 3 ? atoll(argv[3]) : 5000000);
+	LevelSolver solver(threads, maxStates);
+
+	for (int n = 0; n < 100; n++)
+	{
+		ostringstream name;
+		name << "level" << setfill('0') << setw(2) << n << ".dat";
+		Level level(assetDirectory);
+		Level::LoadResult loaded = level.loadLevel(name.str());
+		if (loaded == Level::load_fail_file_not_found)
+			break;
+
+		cout << name.str() << ": ";
+		if (loaded == Level::load_fail_bad_format)
+		{
+			cout << "bad format" << endl;
+			continue;
+		}
+
+		LevelSolver::Result result = solver.solve(level);
+		switch (result.verdict)
+		{
+			case LevelSolver::SOLVED:		cout << "solved in " << result.moves.size() << " moves"; break;
+			case LevelSolver::NO_SOLUTION:	cout << "no solution";	break;
+			case LevelSolver::GAVE_UP:		cout << "gave up";		break;
+			case LevelSolver::UNSUPPORTED:	cout << "more than " << LevelSolver::MAX_JEWELS << " jewels, not searched"; break;
+		}
+		cout << ", " << result.states << " states in " << result.seconds << " s" << endl;
+		if (result.verdict == LevelSolver::SOLVED)
+			cout << "  " << result.moves << endl;
+	}
+	return 0;
+}
+
+  // BoulderBlast --sim-bench [ticks [csvfile [scratchdir]]] times the tick
+  // on every SimBench standard board, that many ticks each, and reports the
+  // nanoseconds per Actor per tick, and the allocations per tick in a build
+  // with SIMBENCH_ALLOCATIONS defined.  The results also go to csvfile if one
+  // is named.  The boards are written into scratchdir, the temporary
+  // directory by default.  In a build with TICK_PROFILE defined each board's
+  // TickProfile is printed too, and its timers are part of the time measured.
+
+static int runSimBench(int argc, char* argv[])
+{
+	long long ticks = (argc > 2 ? atoll(argv[2]) : 20000);
+	string csvPath = (argc > 3 ? argv[3] : "");
+	string scratchDir = (argc > 4 ? argv[4] : "");
+	if (scratchDir.empty())
+	{
+		const char* tmp = getenv("TMPDIR");
+		if (tmp == nullptr)
+			tmp = getenv("TEMP");
+		scratchDir = (tmp != nullptr ? tmp : ".");
+	}
+
+	SimBench bench(scratchDir, ticks);
+	vector<SimBench::Result> results;
+	vector<SimBench::Board> boards = SimBench::standardBoards();
+	for (size_t k = 0; k < boards.size(); k++)
+	{
+		SimBench::Result result;
+		if (!bench.run(boards[k], result))
+		{
+			cout << "Cannot write or load a board in " << scratchDir << endl;
+			return 1;
+		}
+		results.push_back(result);
+
+		cout << result.name << ": " << result.actors << " actors, "
+			 << result.nsPerActorTick << " ns/actor-tick, ";
+		if (SimBench::countsAllocations)
+			cout << result.allocationsPerTick << " allocations/tick, ";
+		cout << result.ticks << " ticks in " << result.seconds << " s" << endl;
+		if (TickProfile::enabled)
+			result.profile.print(cout);
+	}
+
+	if (!csvPath.empty())
+	{
+		ofstream csv(csvPath.c_str());
+		SimBench::writeCsv(csv, results);
+		if (!csv)
+		{
+			cout << "Cannot write " << csvPath << endl;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+  // BoulderBlast --trace file [mode ...] runs any of the modes above, or the
+  // game itself, while writing a Chrome trace of the tick and frame phases
+  // into file.  The trace ends when the program exits.
+
+static void stopTrace()
+{
+	TraceLog::stop();
+}
 
 int main(int argc, char* argv[])
 {
+    if (argc > 2 && string(argv[1]) == "--trace")
+    {
+        if (!TraceLog::start(argv[2]))
+        {
+            cout << "Cannot write " << argv[2] << endl;
+            return 1;
+        }
+        atexit(stopTrace);      //the game only ever ends through exit()
+        argv[2] = argv[0];      //the rest of the arguments pick the mode as usual
+        argv += 2;
+        argc -= 2;
+    }
+
+	  // the only mode that writes its own levels, so it needs no assets
+	if (argc > 1 && string(argv[1]) == "--sim-bench")
+		return runSimBench(argc, argv);
+
 	{
 		string path = assetDirectory;
 		if (!path.empty())
@@ -33,10 +442,31 @@ int main(int argc, char* argv[])
 		}
 	}
 
-    glutInit(&argc, argv);
-
     srand(static_cast<unsigned int>(time(nullptr)));
 
-    GameWorld* gw = createStudentWorld(assetDirectory);
+    if (argc > 1 && string(argv[1]) == "--headless")
+        return runHeadless(argc, argv);
+    if (argc > 1 && string(argv[1]) == "--batch")
+        return runBatch(argc, argv);
+    if (argc > 1 && string(argv[1]) == "--replay")
+        return runReplay(argc, argv);
+    if (argc > 1 && string(argv[1]) == "--snapshot-bench")
+        return runSnapshotBench(argc, argv);
+    if (argc > 1 && string(argv[1]) == "--fork-bench")
+        return runForkBench(argc, argv);
+    if (argc > 1 && string(argv[1]) == "--solve")
+        return runSolve(argc, argv);
+
+    glutInit(&argc, argv);
+
+    unsigned int seed = static_cast<unsigned int>(time(nullptr));
+    GameWorld* gw = createStudentWorld(assetDirectory, seed);
+    if (argc > 2 && string(argv[1]) == "--record")
+    {
+        recording = new Replay(seed, 0);
+        recordingPath = argv[2];
+        gw->startRecording(recording);
+        atexit(saveRecording);      //the game only ever ends through exit()
+    }
     Game().run(gw, "Boulder Blast");
 }